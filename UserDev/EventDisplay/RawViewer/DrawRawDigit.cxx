@@ -2,6 +2,8 @@
 #define EVD_DRAWRAWDIGIT_CXX
 
 #include "DrawRawDigit.h"
+#include "Base/messenger.h"
+#include "TString.h"
 
 //#include "TTree.h"
 //#include "TGraph.h"
@@ -14,6 +16,9 @@
 
 namespace evd {
 
+// analyze always reads the raw digits of this producer
+static const char * kRawDigitProducer = "rawDigitFilterTPC2";
+
 DrawRawDigit::DrawRawDigit(const geo::GeometryCore& geometry, const detinfo::DetectorProperties& detectorProperties) : 
   RawBase(geometry, detectorProperties)
 {
@@ -22,8 +27,22 @@ DrawRawDigit::DrawRawDigit(const geo::GeometryCore& geometry, const detinfo::Det
 
     // And whether or not to correct the data:
     _correct_data = false;
+    _noise_filter_ready = false;
+
+    _keep_raw_and_filtered = false;
+    _showing_filtered = false;
+    _filtered_ready = false;
+    _have_event = false;
+    _is_real_data = false;
+    _n_ticks = 0;
 } 
 
+void DrawRawDigit::SetCorrectData(bool _doit)
+{
+    _correct_data = _doit;
+    if (_keep_raw_and_filtered && _have_event) showFilteredData(_correct_data);
+}
+
 void DrawRawDigit::setPadding(size_t padding, size_t plane) 
 {
     if (_padding_by_plane.size() > plane) _padding_by_plane[plane] = padding;
@@ -47,13 +66,33 @@ bool DrawRawDigit::initialize()
 
     initDataHolder();
   
-    //if (larutil::LArUtilitiesConfig::Detector() == galleryfmwk::geo::kMicroBooNE) {
-    //  _noise_filter.init();
-    //}
+    // The noise filter builds its channel grouping from this geometry and the
+    // readout board map of the detector, if it can't the data is shown unfiltered.
+    _noise_filter_ready = false;
+    try {
+        _noise_filter.init(geoService);
+        _noise_filter_ready = true;
+    }
+    catch (const std::exception & e) {
+        std::cerr << "ERROR: noise filter disabled, " << e.what() << std::endl;
+    }
   
     return true;
 }
 
+std::vector<std::string> DrawRawDigit::resources() const
+{
+    return std::vector<std::string>(1, std::string("raw::RawDigit:") + kRawDigitProducer);
+}
+
+bool DrawRawDigit::prefetch(gallery::Event * ev)
+{
+    // The same producer as analyze, without touching _producer: this runs
+    // on the reader thread while analyze may be running
+    ev->getValidHandle<std::vector<raw::RawDigit> >(art::InputTag(kRawDigitProducer));
+    return true;
+}
+
 bool DrawRawDigit::analyze(gallery::Event *ev) 
 {
     //
@@ -77,16 +116,15 @@ bool DrawRawDigit::analyze(gallery::Event *ev)
     // drawing.
     // So, obviously, first thing to do is to get the wires.
   
-    _producer = "rawDigitFilterTPC2";
+    _producer = kRawDigitProducer;
   
     art::InputTag wires_tag(_producer);
   
-    std::cout << "   wires_tag: " << wires_tag << std::endl;
-  
     auto const &raw_digits =
         ev->getValidHandle<std::vector<raw::RawDigit>>(wires_tag);
   
-    std::cout << "   --> Returned from look up of data, size: " << raw_digits->size() << std::endl;
+    GALLERY_FMWK_MSG(galleryfmwk::msg::kINFO, __FUNCTION__,
+                     Form("Raw digits of %s: %zu", _producer.c_str(), raw_digits->size()));
 
     // if the tick-length set is different from what is actually stored in the ADC
     // vector -> fix.
@@ -101,24 +139,18 @@ bool DrawRawDigit::analyze(gallery::Event *ev)
         }
     }
 
-    _planeData.clear();
-
     size_t n_ticks = raw_digits->front().ADCs().size();
 
-    //if (larutil::LArUtilitiesConfig::Detector() == galleryfmwk::geo::kMicroBooNE) {
-    //  _noise_filter.set_n_time_ticks(n_ticks);
-    //}
-    initDataHolder();
-
     // If the output data holder is not the same size as RawDigit length,
     // it messes up the noise filter.  Easist thing to do here is to
-    // temporarily store the data in it's native format, then copy
+    // store the data in it's native format, then copy
     // the data over to the final output.
 
-    std::vector<std::vector<float>> temp_data_holder(geoService.Nplanes());
+    _n_ticks = n_ticks;
+    _native_data.resize(geoService.Nplanes());
 
     for (size_t i_plane = 0; i_plane < geoService.Nplanes(); i_plane++) 
-        temp_data_holder[i_plane].resize(n_ticks * _x_dimensions[i_plane]);
+        _native_data[i_plane].assign(n_ticks * _x_dimensions[i_plane], 0.0);
 
 
     for (auto const &rawdigit : *raw_digits) 
@@ -134,7 +166,7 @@ bool DrawRawDigit::analyze(gallery::Event *ev)
     
         int offset = wire * n_ticks;
 
-        std::vector<float>&          planeRawDigitVec = temp_data_holder[plane];
+        std::vector<float>&          planeRawDigitVec = _native_data[plane];
         std::vector<float>::iterator startItr         = planeRawDigitVec.begin() + offset;
 
         // Copy with pedestal subtraction
@@ -142,53 +174,103 @@ bool DrawRawDigit::analyze(gallery::Event *ev)
             *startItr++ = adcVal - ped;
    }
 
-
-    //if (larutil::LArUtilitiesConfig::Detector() == galleryfmwk::geo::kMicroBooNE) {
-    //  _noise_filter.set_data(&_temp_data_holder);
-    //  if (_correct_data && ev->eventAuxiliary().isRealData()) {
-    //    _noise_filter.clean_data();
-    //  } else {
-    //    _noise_filter.pedestal_subtract_only();
-    //  }
-    //}
-  
     // In some cases, raw digits are truncated and the padding is needed.
     // In other cases, raw digits are not truncated and no padding is needed,
     // even in a truncate file.  What a mess.
     // Hack: wipe out the padding if it's clearly not needed:
   
-    std::vector<int> _temp_padding_by_plane(_padding_by_plane.size(), 0);
+    _event_padding_by_plane.assign(_padding_by_plane.size(), 0);
   
     for (size_t i_plane = 0; i_plane < geoService.Nviews(); i_plane++) 
     {
         if (n_ticks + _padding_by_plane[i_plane] > _y_dimensions[i_plane]) 
-            _temp_padding_by_plane[i_plane] = 0;
+            _event_padding_by_plane[i_plane] = 0;
         else                                                                
-            _temp_padding_by_plane[i_plane] = _padding_by_plane[i_plane];
+            _event_padding_by_plane[i_plane] = _padding_by_plane[i_plane];
+    }
+
+    _have_event = true;
+    _is_real_data = ev->eventAuxiliary().isRealData();
+    _filtered_ready = false;
+    _showing_filtered = false;
+
+    if (_keep_raw_and_filtered)
+    {
+        // Show the raw data, the filtered data is made when first requested
+        fillPlaneData(_planeData);
+        if (_correct_data) showFilteredData(true);
+    }
+    else
+    {
+        // The raw digits are already pedestal subtracted above, so the filter is
+        // only needed when the data is to be corrected:
+        if (_correct_data) _showing_filtered = filterNativeData();
+        fillPlaneData(_planeData);
     }
 
-    // Now, copy the data from the temp storage to the output storage:
+    return true;
+}
+
+bool DrawRawDigit::filterNativeData()
+{
+    if (!_noise_filter_ready || !_is_real_data) return false;
+
+    try {
+        _noise_filter.set_n_time_ticks(_n_ticks);
+        _noise_filter.set_data(&_native_data);
+        _noise_filter.clean_data();
+    }
+    catch (const std::exception & e) {
+        std::cerr << "ERROR: noise filter failed on this event, " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void DrawRawDigit::fillPlaneData(std::vector<std::vector<float> > & _output) const
+{
+    // Copy the data from the native storage to the output storage:
+    _output.resize(_native_data.size());
   
-    for (size_t i_plane = 0; i_plane < geoService.Nplanes(); i_plane++) 
+    for (size_t i_plane = 0; i_plane < _native_data.size(); i_plane++) 
     {
-        size_t n_wires = temp_data_holder[i_plane].size() / n_ticks;
+        size_t n_wires = _native_data[i_plane].size() / _n_ticks;
   
-        std::vector<float>& planeTempData = temp_data_holder[i_plane];
-        std::vector<float>& planeData     = _planeData[i_plane];
+        const std::vector<float>& planeTempData = _native_data[i_plane];
+        std::vector<float>&       planeData     = _output[i_plane];
+
+        planeData.assign(_x_dimensions[i_plane] * _y_dimensions[i_plane], 0.0);
   
         for (size_t i_wire = 0; i_wire < n_wires; i_wire++) 
         {
-            size_t offset_raw   = i_wire * n_ticks;
-            size_t offset_final = i_wire * _y_dimensions[i_plane] + _temp_padding_by_plane[i_plane];
+            size_t offset_raw   = i_wire * _n_ticks;
+            size_t offset_final = i_wire * _y_dimensions[i_plane] + _event_padding_by_plane[i_plane];
 
-            std::vector<float>::iterator tempDataItr  = planeTempData.begin() + offset_raw;
-            std::vector<float>::iterator planeDataItr = planeData.begin() + offset_final;
+            std::vector<float>::const_iterator tempDataItr  = planeTempData.begin() + offset_raw;
+            std::vector<float>::iterator       planeDataItr = planeData.begin() + offset_final;
 
-            std::copy(tempDataItr,tempDataItr+n_ticks,planeDataItr);
+            std::copy(tempDataItr,tempDataItr+_n_ticks,planeDataItr);
         }
     }
+}
 
-    return true;
+void DrawRawDigit::showFilteredData(bool _filtered)
+{
+    if (_filtered == _showing_filtered) return;
+
+    if (_filtered && !_filtered_ready)
+    {
+        // The raw planes are already in _planeData, so the native data
+        // can be filtered in place:
+        if (!filterNativeData()) return;
+        fillPlaneData(_other_plane_data);
+        _filtered_ready = true;
+    }
+
+    // The numpy arrays returned by getArrayByPlane point to the old buffers,
+    // they have to be requested again after this.
+    _planeData.swap(_other_plane_data);
+    _showing_filtered = _filtered;
 }
 
 bool DrawRawDigit::finalize() 
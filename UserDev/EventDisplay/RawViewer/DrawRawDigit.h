@@ -18,7 +18,7 @@
 #include "Analysis/anabase.h"
 //#include "LArUtil/Geometria.h"
 #include "RawBase.h"
-//#include "UbooneNoiseFilter/UbooneNoiseFilter.h"
+#include "UbooneNoiseFilter/UbooneNoiseFilter.h"
 
 //#include "TTree.h"
 //#include "TGraph.h"
@@ -65,21 +65,72 @@ public:
     */
     virtual bool analyze(gallery::Event * event);
 
+    /// Reads one product, see anabase::resources
+    virtual std::vector<std::string> resources() const;
+
+    virtual bool prefetch(gallery::Event * event);
+
     /** IMPLEMENT in DrawRawDigit.cc!
         Finalize method to be called after all events processed.
     */
     virtual bool finalize();
 
-    void SetCorrectData(bool _doit = true) {_correct_data = _doit;}
+    /**
+     * @brief Choose between the raw and the noise filtered data
+     * @details If both versions are kept (see SetKeepRawAndFiltered) and an
+     *          event is loaded, this switches the returned planes right away,
+     *          running the noise filter the first time it is requested.
+     *          Otherwise it applies from the next event.
+     */
+    void SetCorrectData(bool _doit = true);
+
+    /**
+     * @brief Keep the raw and the filtered planes of the current event
+     * @details The filtered planes are only computed when first requested.
+     *          Switching with SetCorrectData then only swaps the buffers,
+     *          at the cost of a second copy of the planes in memory.
+     */
+    void SetKeepRawAndFiltered(bool _doit = true) {_keep_raw_and_filtered = _doit;}
+
+    /// Whether getArrayByPlane currently returns the filtered data
+    bool IsShowingFilteredData() const {return _showing_filtered;}
+
     void setPadding(size_t padding, size_t plane);
 
 
 private:
 
+    /// Run the noise filter in place on _native_data, return true on success
+    bool filterNativeData();
+
+    /// Copy _native_data into the padded layout returned to python
+    void fillPlaneData(std::vector<std::vector<float> > & _output) const;
+
+    /// Swap the raw or filtered planes into _planeData
+    void showFilteredData(bool _filtered);
+
     // Store whether or not to correct the data
     bool _correct_data;
 
-    //ub_noise_filter::UbooneNoiseFilter _noise_filter;
+    // Raw and filtered buffers, see SetKeepRawAndFiltered
+    bool _keep_raw_and_filtered;
+    bool _showing_filtered;
+    bool _filtered_ready;
+    bool _have_event;
+    bool _is_real_data;
+
+    // The current event in its native layout, [plane][wire * _n_ticks + tick]
+    std::vector<std::vector<float> > _native_data;
+    size_t _n_ticks;
+    std::vector<size_t> _event_padding_by_plane;
+
+    // The planes not currently in _planeData (raw or filtered)
+    std::vector<std::vector<float> > _other_plane_data;
+
+    // The noise filter is only used if it could load the detector layout
+    ub_noise_filter::UbooneNoiseFilter _noise_filter;
+    bool _noise_filter_ready;
+
     std::vector<size_t> _padding_by_plane;
 
 };
@@ -17,6 +17,9 @@
 
 namespace evd {
 
+// analyze always reads the wires of this producer
+static const char * kWireProducer = "decon1DroiTPC2";
+
 DrawWire::DrawWire(const geo::GeometryCore& geometry, const detinfo::DetectorProperties& detectorProperties) :
     RawBase(geometry, detectorProperties)
 {
@@ -51,6 +54,19 @@ bool DrawWire::initialize()
     return true;
 }
 
+std::vector<std::string> DrawWire::resources() const
+{
+    return std::vector<std::string>(1, std::string("recob::Wire:") + kWireProducer);
+}
+
+bool DrawWire::prefetch(gallery::Event * ev)
+{
+    // The same producer as analyze, without touching _producer: this runs
+    // on the reader thread while analyze may be running
+    ev->getValidHandle<std::vector <recob::Wire> >(art::InputTag(kWireProducer));
+    return true;
+}
+
 bool DrawWire::analyze(gallery::Event * ev)
 {
     //
@@ -72,7 +88,7 @@ bool DrawWire::analyze(gallery::Event * ev)
   
     // This is an event viewer.  In particular, this handles raw wire signal drawing.
     // So, obviously, first thing to do is to get the wires.
-    _producer = "decon1DroiTPC2";
+    _producer = kWireProducer;
   
     art::InputTag wires_tag(_producer);
     auto const & wires = ev -> getValidHandle<std::vector <recob::Wire> >(wires_tag);
@@ -63,6 +63,11 @@ namespace evd {
     */
     virtual bool analyze(gallery::Event * event);
 
+    /// Reads one product, see anabase::resources
+    virtual std::vector<std::string> resources() const;
+
+    virtual bool prefetch(gallery::Event * event);
+
     /** IMPLEMENT in DrawWire.cc! 
         Finalize method to be called after all events processed.
     */
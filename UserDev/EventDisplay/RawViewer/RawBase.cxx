@@ -2,6 +2,8 @@
 #define RAWBASE_CXX
 
 #include "RawBase.h"
+#include "Base/messenger.h"
+#include "TString.h"
 
 namespace evd {
 
@@ -9,7 +11,6 @@ RawBase::RawBase(const geo::GeometryCore& geometry, const detinfo::DetectorPrope
   geoService(geometry),
   detProp(detectorProperties)
 {
-    _import_array();
 }
 
 RawBase::~RawBase() {}
@@ -43,7 +44,12 @@ bool RawBase::fileExists(std::string s)
 
 PyObject* RawBase::getArrayByPlane(unsigned int p) 
 {
-    std::cout << "Recovering plane data for plane: " << p << std::endl;
+    GALLERY_FMWK_DEBUG(__FUNCTION__, Form("Recovering plane data for plane: %u", p));
+
+    // numpy is imported on the first array, the drawers themselves run
+    // without a python interpreter (render_events)
+    static const bool numpy_imported = (_import_array() >= 0);
+    if (!numpy_imported) return nullptr;
 
     PyObject* result = nullptr;
 
@@ -58,14 +64,13 @@ PyObject* RawBase::getArrayByPlane(unsigned int p)
         dims[1] = _y_dimensions[p];
         int data_type = NPY_FLOAT; //PyArray_FLOAT;
   
-        std::cout << "--> returning PyObject with n_dim: " << n_dim << ", dims: " << dims[0] << "/" << dims[1] << ", data_type: " << data_type << ", size data: " << _planeData[p].size() << std::endl;
-        std::cout << "    size of planedata for plane: " << p << " is " << _planeData[p].size() << ", value at plane data: " << _planeData[p].data() << std::endl;
+        GALLERY_FMWK_DEBUG(__FUNCTION__, Form("--> returning PyObject with n_dim: %d, dims: %ld/%ld, data_type: %d, size data: %zu",
+                                              n_dim, dims[0], dims[1], data_type, _planeData[p].size()));
   
         //PyArrayObject* result = PyArray_FromDimsAndData(n_dim, dims, data_type, (char*)_planeData[p].data() );
         result = PyArray_SimpleNewFromData(n_dim, dims, NPY_FLOAT, _planeData[p].data());
   
-        std::cout << "Did I even return?" << std::endl;
-        std::cout << "    >> created PyObject, pointer: " << result << std::endl;
+        GALLERY_FMWK_DEBUG(__FUNCTION__, Form("    >> created PyObject, pointer: %p", (void*) result));
     }
 
   return result;
@@ -84,7 +89,7 @@ void RawBase::setYDimension(unsigned int y_dim, unsigned int plane)
 {
     if (_y_dimensions.size() < plane + 1) _y_dimensions.resize(plane + 1);
 
-    std::cout << "***** Setting y dim for plane " << plane << " to " << y_dim << std::endl;
+    GALLERY_FMWK_DEBUG(__FUNCTION__, Form("Setting y dim for plane %u to %u", plane, y_dim));
     _y_dimensions.at(plane) = y_dim;
 
     return;
@@ -0,0 +1,58 @@
+//
+// Channel map choice of the batch programs of this directory.
+//
+// "icarus" is the ICARUS channel map of icarusalg, the one the event display
+// uses for ICARUS files.  It is only built in when icarusalg is set up (see
+// EVD_ICARUS_CHANNEL_MAP in the GNUmakefile), and is then the default.
+// "standard" is geo::ChannelMapStandardAlg, for single TPC detectors such
+// as MicroBooNE.
+//
+
+#ifndef EVD_BIN_CHANNEL_MAP_H
+#define EVD_BIN_CHANNEL_MAP_H
+
+#include "larcorealg/Geometry/ChannelMapStandardAlg.h"
+#include "larcorealg/Geometry/StandaloneGeometrySetup.h"
+#ifdef EVD_ICARUS_CHANNEL_MAP
+#include "icarusalg/Geometry/ChannelMapIcarusAlg.h"
+#endif
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+#ifdef EVD_ICARUS_CHANNEL_MAP
+const char * const kDefaultChannelMap = "icarus";
+const char * const kChannelMaps = "icarus or standard";
+#else
+const char * const kDefaultChannelMap = "standard";
+const char * const kChannelMaps = "standard";
+#endif
+
+/// True if setup_geometry knows this channel map
+bool known_channel_map(const std::string & channel_map)
+{
+#ifdef EVD_ICARUS_CHANNEL_MAP
+  if (channel_map == "icarus") return true;
+#endif
+  return channel_map == "standard";
+}
+
+/// The geometry of this Geometry configuration, with the named channel map
+std::unique_ptr<geo::GeometryCore> setup_geometry(const fhicl::ParameterSet & pset,
+                                                  const std::string & channel_map)
+{
+#ifdef EVD_ICARUS_CHANNEL_MAP
+  if (channel_map == "icarus")
+    return lar::standalone::SetupGeometry<geo::ChannelMapIcarusAlg>(pset);
+#endif
+  if (channel_map == "standard")
+    return lar::standalone::SetupGeometry<geo::ChannelMapStandardAlg>(pset);
+  throw std::runtime_error("unknown channel map " + channel_map + ", use " + kChannelMaps);
+}
+
+}
+
+#endif
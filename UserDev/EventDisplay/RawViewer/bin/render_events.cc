@@ -0,0 +1,495 @@
+//
+// Batch renderer of event display images, without python or Qt.
+//
+// Every plane of every event is drawn like the event display does: the wire
+// (or raw digit) data through the colormap and levels of the ICARUS
+// configuration, with optionally the hits and the tracks of a producer drawn
+// on top.  Each plane is written as a PNG, or as raw 8 bit RGBA, to
+//   <dir>/evd_<run>_<subrun>_<event>_plane<p>.png
+//   <dir>/evd_<run>_<subrun>_<event>_plane<p>_<width>x<height>.rgba
+// The image is wires wide and ticks high, tick 0 at the bottom.
+//
+// Events are rendered in parallel, each anaprocessor thread runs its own
+// drawers (see anabase::clone).
+//
+// The services are set up from a FHiCL file with the Geometry,
+// LArPropertiesService, DetectorClocksService and DetectorPropertiesService
+// configurations under "services", as for a LArSoft job.  The channel map
+// is chosen with -c (see channel_map.h).
+//
+// The noise filter of the display is not available here: raw digits are
+// drawn pedestal subtracted only.
+//
+// Usage:
+//   > render_events [options] services.fcl file [file ...]
+//     -o dir       output directory (.)
+//     -j threads   threads, 0 for one per core (0)
+//     -n events    render only the first events (all)
+//     -c map       channel map, icarus or standard (icarus if built with icarusalg)
+//     -r           raw digits instead of wires, not noise filtered
+//     -H producer  draw the hits of this producer
+//     -T producer  draw the tracks of this producer
+//     -t ticks     ticks per pixel row, the largest signal of them is drawn (1)
+//     -l min,max   levels of every plane (the ICARUS levels)
+//     -f format    png or rgba (png)
+//
+
+#include "Analysis/anaprocessor.h"
+#include "RawViewer/DrawRawDigit.h"
+#include "RawViewer/DrawWire.h"
+#include "RecoViewer/DrawHit.h"
+#include "RecoViewer/DrawTrack.h"
+
+#include "channel_map.h"
+
+#include "larcorealg/Geometry/StandaloneBasicSetup.h"
+#include "lardataalg/DetectorInfo/DetectorClocksStandard.h"
+#include "lardataalg/DetectorInfo/DetectorPropertiesStandard.h"
+#include "lardataalg/DetectorInfo/LArPropertiesStandard.h"
+
+#include <zlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// What to draw and how, shared by every thread
+struct render_config {
+  bool raw_digits = false;
+  std::string hit_producer;
+  std::string track_producer;
+  std::string output_dir = ".";
+  bool png = true;
+  unsigned int tick_step = 1;
+  std::vector<std::pair<float, float> > levels;   ///< (min, max) of each plane
+};
+
+struct rgba_t {unsigned char r, g, b, a;};
+
+/// Colormap of the ICARUS planes in python/evdmanager/detectorConfiguration.py
+class colormap {
+
+public:
+
+  colormap()
+  {
+    _ticks = {
+      {0.0,     {22, 30, 151, 255}},
+      {0.33333, {0, 181, 226, 255}},
+      {0.47,    {76, 140, 43, 255}},
+      {0.645,   {0, 206, 24, 255}},
+      {0.791,   {254, 209, 65, 255}},
+      {1.0,     {255, 0, 0, 255}}
+    };
+    // A lookup table, pixels then take one multiply and one load
+    _table.resize(kSIZE);
+    for (size_t i = 0; i < kSIZE; i++) _table[i] = interpolate(i / float(kSIZE - 1));
+  }
+
+  /// Color of a value, clipped to the levels
+  rgba_t operator()(float value, float min, float max) const
+  {
+    float x = (max > min) ? (value - min) / (max - min) : 0;
+    x = std::min(std::max(x, 0.f), 1.f);
+    return _table[size_t(x * (kSIZE - 1) + 0.5)];
+  }
+
+private:
+
+  rgba_t interpolate(float x) const
+  {
+    size_t i = 1;
+    while (i < _ticks.size() - 1 && _ticks[i].first < x) i++;
+    auto const & lo = _ticks[i - 1];
+    auto const & hi = _ticks[i];
+    float f = (x - lo.first) / (hi.first - lo.first);
+    auto mix = [f](unsigned char a, unsigned char b) {return (unsigned char)(a + f * (b - a) + 0.5);};
+    return rgba_t{mix(lo.second.r, hi.second.r), mix(lo.second.g, hi.second.g),
+                  mix(lo.second.b, hi.second.b), 255};
+  }
+
+  static const size_t kSIZE = 1024;
+
+  std::vector<std::pair<float, rgba_t> > _ticks;
+  std::vector<rgba_t> _table;
+};
+
+/// An RGBA image, row 0 at the top
+class image {
+
+public:
+
+  image(size_t width, size_t height) : _width(width), _height(height), _pixels(width * height) {}
+
+  size_t width() const {return _width;}
+  size_t height() const {return _height;}
+
+  rgba_t & at(size_t x, size_t y) {return _pixels[y * _width + x];}
+
+  void set(long x, long y, rgba_t color)
+  {
+    if (x >= 0 && y >= 0 && x < (long) _width && y < (long) _height) at(x, y) = color;
+  }
+
+  /// Straight line between two pixels (Bresenham)
+  void line(long x0, long y0, long x1, long y1, rgba_t color)
+  {
+    long dx = std::labs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    long dy = -std::labs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    long err = dx + dy;
+    while (true) {
+      set(x0, y0, color);
+      if (x0 == x1 && y0 == y1) break;
+      long e2 = 2 * err;
+      if (e2 >= dy) {err += dy; x0 += sx;}
+      if (e2 <= dx) {err += dx; y0 += sy;}
+    }
+  }
+
+  /// 8 bit RGBA PNG
+  bool write_png(const std::string & path) const
+  {
+    // Every row starts with its filter type, 0 (none)
+    std::vector<unsigned char> raw;
+    raw.reserve(_height * (_width * 4 + 1));
+    for (size_t y = 0; y < _height; y++) {
+      raw.push_back(0);
+      auto row = reinterpret_cast<const unsigned char*>(&_pixels[y * _width]);
+      raw.insert(raw.end(), row, row + _width * 4);
+    }
+
+    uLongf size = compressBound(raw.size());
+    std::vector<unsigned char> compressed(size);
+    if (compress2(compressed.data(), &size, raw.data(), raw.size(), Z_BEST_SPEED) != Z_OK)
+      return false;
+    compressed.resize(size);
+
+    unsigned char header[13];
+    put32(header, _width);
+    put32(header + 4, _height);
+    header[8] = 8;    // bits per channel
+    header[9] = 6;    // RGBA
+    header[10] = header[11] = header[12] = 0;
+
+    std::ofstream out(path.c_str(), std::ios::binary);
+    static const unsigned char signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+    out.write(reinterpret_cast<const char*>(signature), 8);
+    chunk(out, "IHDR", header, sizeof(header));
+    chunk(out, "IDAT", compressed.data(), compressed.size());
+    chunk(out, "IEND", 0, 0);
+    return bool(out);
+  }
+
+  /// The pixels as they are in memory, width * height * 4 bytes
+  bool write_rgba(const std::string & path) const
+  {
+    std::ofstream out(path.c_str(), std::ios::binary);
+    out.write(reinterpret_cast<const char*>(_pixels.data()), _pixels.size() * sizeof(rgba_t));
+    return bool(out);
+  }
+
+private:
+
+  static void put32(unsigned char * p, uint32_t v)
+  {
+    p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+  }
+
+  static void chunk(std::ofstream & out, const char * type, const unsigned char * data, size_t size)
+  {
+    unsigned char length[4];
+    put32(length, size);
+    out.write(reinterpret_cast<const char*>(length), 4);
+    out.write(type, 4);
+    if (size) out.write(reinterpret_cast<const char*>(data), size);
+
+    // The CRC covers the type and the data
+    uLong crc = crc32(0L, reinterpret_cast<const Bytef*>(type), 4);
+    if (size) crc = crc32(crc, data, size);
+    unsigned char crc_bytes[4];
+    put32(crc_bytes, crc);
+    out.write(reinterpret_cast<const char*>(crc_bytes), 4);
+  }
+
+  size_t _width;
+  size_t _height;
+  std::vector<rgba_t> _pixels;
+};
+
+/**
+   Draws every plane of each event with DrawWire or DrawRawDigit, and DrawHit
+   and DrawTrack for the overlays, and writes the images.  The drawers belong
+   to this module, so a clone has its own and the threads share nothing.
+*/
+class event_renderer : public galleryfmwk::anabase {
+
+public:
+
+  event_renderer(const geo::GeometryCore & geometry, const detinfo::DetectorProperties & detProp,
+                 const render_config & config)
+    : _geometry(geometry), _detProp(detProp), _config(config), _raw(0), _images(0)
+  {
+    _name = "event_renderer";
+    _fout = 0;
+  }
+
+  bool initialize()
+  {
+    if (!_raw_module) {
+      if (_config.raw_digits) {
+        auto drawer = new evd::DrawRawDigit(_geometry, _detProp);
+        _raw_module.reset(drawer);
+        _raw = drawer;
+      }
+      else {
+        auto drawer = new evd::DrawWire(_geometry, _detProp);
+        _raw_module.reset(drawer);
+        _raw = drawer;
+      }
+      if (!_config.hit_producer.empty()) {
+        _hits.reset(new evd::DrawHit(_geometry, _detProp));
+        _hits->setProducer(_config.hit_producer);
+      }
+      if (!_config.track_producer.empty()) {
+        _tracks.reset(new evd::DrawTrack(_geometry, _detProp));
+        _tracks->setProducer(_config.track_producer);
+      }
+    }
+
+    bool status = _raw_module->initialize();
+    if (_hits) status = _hits->initialize() && status;
+    if (_tracks) status = _tracks->initialize() && status;
+    return status;
+  }
+
+  bool prefetch(gallery::Event * ev)
+  {
+    bool status = _raw_module->prefetch(ev);
+    if (_hits) status = _hits->prefetch(ev) && status;
+    if (_tracks) status = _tracks->prefetch(ev) && status;
+    return status;
+  }
+
+  bool analyze(gallery::Event * ev)
+  {
+    if (!_raw_module->analyze(ev)) return false;
+    if (_hits && !_hits->analyze(ev)) return false;
+    if (_tracks && !_tracks->analyze(ev)) return false;
+
+    auto const & aux = ev->eventAuxiliary();
+    std::stringstream prefix;
+    prefix << _config.output_dir << "/evd_" << aux.run() << "_" << aux.subRun() << "_" << aux.event();
+
+    for (unsigned int p = 0; p < _geometry.Nplanes(); p++) {
+
+      image plane_image = render(p);
+
+      std::stringstream path;
+      path << prefix.str() << "_plane" << p;
+      bool written;
+      if (_config.png) {
+        path << ".png";
+        written = plane_image.write_png(path.str());
+      }
+      else {
+        path << "_" << plane_image.width() << "x" << plane_image.height() << ".rgba";
+        written = plane_image.write_rgba(path.str());
+      }
+
+      if (!written) {
+        std::cerr << "ERROR: Could not write " << path.str() << std::endl;
+        return false;
+      }
+      _images++;
+    }
+    return true;
+  }
+
+  bool finalize()
+  {
+    if (_raw_module) _raw_module->finalize();
+    if (_hits) _hits->finalize();
+    if (_tracks) _tracks->finalize();
+    std::cout << "Wrote " << _images << " images to " << _config.output_dir << std::endl;
+    return true;
+  }
+
+  anabase* clone() const {return new event_renderer(_geometry, _detProp, _config);}
+
+  bool merge(const anabase & worker)
+  {
+    _images += static_cast<const event_renderer&>(worker)._images;
+    return true;
+  }
+
+private:
+
+  image render(unsigned int plane)
+  {
+    const std::vector<float> & data = _raw->getDataByPlane(plane);
+    size_t n_wires = _geometry.Nwires(plane);
+    size_t n_ticks = n_wires ? data.size() / n_wires : 0;
+    size_t step = std::max(_config.tick_step, 1u);
+    size_t height = (n_ticks + step - 1) / step;
+
+    auto const & levels = _config.levels.at(std::min<size_t>(plane, _config.levels.size() - 1));
+
+    image result(n_wires, height);
+
+    for (size_t wire = 0; wire < n_wires; wire++) {
+      const float * ticks = data.data() + wire * n_ticks;
+      for (size_t row = 0; row < height; row++) {
+        // The largest signal of the ticks of this row, either sign
+        size_t first = row * step;
+        size_t last = std::min(first + step, n_ticks);
+        float value = ticks[first];
+        for (size_t tick = first + 1; tick < last; tick++)
+          if (std::fabs(ticks[tick]) > std::fabs(value)) value = ticks[tick];
+        result.at(wire, height - 1 - row) = _colormap(value, levels.first, levels.second);
+      }
+    }
+
+    auto tick_to_y = [height, step](double tick) {return long(height) - 1 - long(std::floor(tick / step));};
+
+    if (_hits) {
+      static const rgba_t kHIT = {255, 255, 255, 255};
+      for (auto const & hit : _hits->getDataByPlane(plane)) {
+        long x = long(hit.wire());
+        result.line(x, tick_to_y(hit.start_time()), x, tick_to_y(hit.end_time()), kHIT);
+      }
+    }
+
+    if (_tracks) {
+      // Track points are (wire * pitch, x) in cm
+      static const rgba_t kTRACK = {255, 0, 255, 255};
+      double pitch = _geometry.WirePitch(plane);
+      for (auto const & track : _tracks->getDataByPlane(plane)) {
+        auto points = track.track(0);
+        for (size_t i = 1; i < points.size(); i++) {
+          result.line(long(points[i - 1].first / pitch),
+                      tick_to_y(_detProp.ConvertXToTicks(points[i - 1].second, plane, 0, 0)),
+                      long(points[i].first / pitch),
+                      tick_to_y(_detProp.ConvertXToTicks(points[i].second, plane, 0, 0)),
+                      kTRACK);
+        }
+      }
+    }
+
+    return result;
+  }
+
+  const geo::GeometryCore & _geometry;
+  const detinfo::DetectorProperties & _detProp;
+  render_config _config;
+  colormap _colormap;
+
+  std::unique_ptr<galleryfmwk::anabase> _raw_module;
+  evd::RawBase * _raw;                      ///< _raw_module as a RawBase
+  std::unique_ptr<evd::DrawHit> _hits;
+  std::unique_ptr<evd::DrawTrack> _tracks;
+
+  size_t _images;
+};
+
+void usage(const char * program)
+{
+  std::cerr << "Usage: " << program << " [-o dir] [-j threads] [-n events] [-c channel_map] [-r]"
+            << " [-H hit_producer] [-T track_producer] [-t ticks] [-l min,max] [-f png|rgba]"
+            << " services.fcl file [file ...]" << std::endl
+            << "  channel_map is " << kChannelMaps << " (" << kDefaultChannelMap << ")" << std::endl
+            << "  -r draws the raw digits pedestal subtracted, the noise filter is not available here"
+            << std::endl;
+}
+
+}
+
+int main(int argc, char ** argv)
+{
+  render_config config;
+  // icarusConfiguration in python/evdmanager/detectorConfiguration.py
+  config.levels = {{-40, 160}, {-40, 160}, {-80, 320}};
+
+  unsigned int n_threads = 0;
+  unsigned int n_events = 0;
+  std::string channel_map = kDefaultChannelMap;
+
+  int option;
+  while ((option = getopt(argc, argv, "o:j:n:c:rH:T:t:l:f:")) != -1) {
+    switch (option) {
+    case 'o': config.output_dir = optarg; break;
+    case 'j': n_threads = std::atoi(optarg); break;
+    case 'n': n_events = std::atoi(optarg); break;
+    case 'c':
+      channel_map = optarg;
+      if (!known_channel_map(channel_map)) {
+        usage(argv[0]);
+        return 1;
+      }
+      break;
+    case 'r': config.raw_digits = true; break;
+    case 'H': config.hit_producer = optarg; break;
+    case 'T': config.track_producer = optarg; break;
+    case 't': config.tick_step = std::max(std::atoi(optarg), 1); break;
+    case 'l': {
+      float min, max;
+      if (std::sscanf(optarg, "%f,%f", &min, &max) != 2) {
+        usage(argv[0]);
+        return 1;
+      }
+      config.levels.assign(1, std::make_pair(min, max));
+      break;
+    }
+    case 'f':
+      if (std::string(optarg) != "png" && std::string(optarg) != "rgba") {
+        usage(argv[0]);
+        return 1;
+      }
+      config.png = std::string(optarg) == "png";
+      break;
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (argc - optind < 2) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  std::string services = argv[optind];
+  std::vector<std::string> files(argv + optind + 1, argv + argc);
+
+  // The providers a LArSoft job would get from its services
+  auto pset = lar::standalone::ParseConfiguration(services);
+  auto geometry = setup_geometry(pset.get<fhicl::ParameterSet>("services.Geometry"), channel_map);
+  detinfo::LArPropertiesStandard larProp(pset.get<fhicl::ParameterSet>("services.LArPropertiesService"),
+                                         {"service_provider", "service_type"});
+  detinfo::DetectorClocksStandard clocks(pset.get<fhicl::ParameterSet>("services.DetectorClocksService"));
+  detinfo::DetectorPropertiesStandard detProp(pset.get<fhicl::ParameterSet>("services.DetectorPropertiesService"),
+                                              geometry.get(), &larProp, &clocks,
+                                              {"service_provider", "service_type"});
+
+  if (!n_threads) n_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  galleryfmwk::anaprocessor processor;
+  for (auto const & file : files) processor.add_input_file(file);
+  processor.set_n_threads(n_threads);
+
+  event_renderer renderer(*geometry, detProp, config);
+  processor.add_process(&renderer);
+
+  return processor.run(n_events) ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+//
+// Per event summary of a file list, to find the busy events before opening
+// them in the display.
+//
+// For each event: the charge and ROI occupancy of each plane from
+// recob::Wire, the hits of each plane, and the number of tracks and
+// showers (see evd::EventSummary).  Only the products of the producers
+// given are read.  Events are summarized in parallel and written as the
+// tree "eventsummary" of the output file, which the display opens with
+// "Event List".
+//
+// The geometry is set up from the Geometry configuration under "services"
+// of a FHiCL file, with the channel map chosen by -c, as for render_events.
+//
+// Usage:
+//   > summarize_events [options] services.fcl output.root file [file ...]
+//     -j threads   threads, 0 for one per core (0)
+//     -n events    summarize only the first events (all)
+//     -c map       channel map, icarus or standard (icarus if built with icarusalg)
+//     -w producer  recob::Wire producer
+//     -H producer  recob::Hit producer
+//     -T producer  recob::Track producer
+//     -S producer  recob::Shower producer
+//
+
+#include "Analysis/anaprocessor.h"
+#include "RecoViewer/EventSummary.h"
+
+#include "channel_map.h"
+
+#include "larcorealg/Geometry/StandaloneBasicSetup.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char ** argv)
+{
+  std::string wire_producer, hit_producer, track_producer, shower_producer;
+  unsigned int n_threads = 0;
+  unsigned int n_events = 0;
+  std::string channel_map = kDefaultChannelMap;
+
+  int option;
+  while ((option = getopt(argc, argv, "j:n:c:w:H:T:S:")) != -1) {
+    switch (option) {
+    case 'j': n_threads = std::atoi(optarg); break;
+    case 'n': n_events = std::atoi(optarg); break;
+    case 'c': channel_map = optarg; break;
+    case 'w': wire_producer = optarg; break;
+    case 'H': hit_producer = optarg; break;
+    case 'T': track_producer = optarg; break;
+    case 'S': shower_producer = optarg; break;
+    default: optind = argc; break;
+    }
+  }
+
+  if (argc - optind < 3 || !known_channel_map(channel_map) ||
+      (wire_producer.empty() && hit_producer.empty() && track_producer.empty() && shower_producer.empty())) {
+    std::cerr << "Usage: " << argv[0] << " [-j threads] [-n events] [-c channel_map] [-w wire_producer]"
+              << " [-H hit_producer] [-T track_producer] [-S shower_producer]"
+              << " services.fcl output.root file [file ...]" << std::endl
+              << "  channel_map is " << kChannelMaps << " (" << kDefaultChannelMap << ")"
+              << std::endl;
+    return 1;
+  }
+
+  std::string services = argv[optind];
+  std::string output = argv[optind + 1];
+  std::vector<std::string> files(argv + optind + 2, argv + argc);
+
+  auto pset = lar::standalone::ParseConfiguration(services);
+  auto geometry = setup_geometry(pset.get<fhicl::ParameterSet>("services.Geometry"), channel_map);
+
+  if (!n_threads) n_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  galleryfmwk::anaprocessor processor;
+  for (auto const & file : files) processor.add_input_file(file);
+  processor.set_ana_output_file(output);
+  processor.set_n_threads(n_threads);
+
+  evd::EventSummary summary(*geometry);
+  summary.setWireProducer(wire_producer);
+  summary.setHitProducer(hit_producer);
+  summary.setTrackProducer(track_producer);
+  summary.setShowerProducer(shower_producer);
+  processor.add_process(&summary);
+
+  if (!processor.run(n_events)) return 1;
+
+  std::cout << "Summarized " << summary.size() << " events in " << output << std::endl;
+  return 0;
+}
@@ -0,0 +1,52 @@
+#ifndef EVD_ASSOCIATIONCACHE_CXX
+#define EVD_ASSOCIATIONCACHE_CXX
+
+#include "AssociationCache.h"
+
+namespace evd {
+
+AssociationCache::AssociationCache() :
+  _event(nullptr),
+  _file_entry(-1),
+  _event_entry(-1),
+  _has_event(false)
+{}
+
+AssociationCache::~AssociationCache()
+{
+  clear();
+}
+
+AssociationCache & AssociationCache::GetME()
+{
+  static AssociationCache cache;
+  return cache;
+}
+
+void AssociationCache::set_event(gallery::Event * ev)
+{
+  art::EventID id = ev->eventAuxiliary().id();
+  if (_has_event && ev == _event &&
+      ev->fileEntry() == _file_entry &&
+      ev->eventEntry() == _event_entry &&
+      id == _event_id)
+    return;
+
+  _event = ev;
+  _file_entry = ev->fileEntry();
+  _event_entry = ev->eventEntry();
+  _event_id = id;
+  _has_event = true;
+  clear();
+}
+
+void AssociationCache::clear()
+{
+  for (auto & association : _associations)
+    delete association.second;
+  _associations.clear();
+}
+
+} // evd
+
+#endif
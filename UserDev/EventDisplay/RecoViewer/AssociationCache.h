@@ -0,0 +1,198 @@
+/**
+ * \file AssociationCache.h
+ *
+ * \ingroup RecoViewer
+ *
+ * \brief Class def header for a class AssociationCache
+ *
+ * Per event cache of associations shared by the drawers.  Each association
+ * is resolved once per event with art::FindManyP and flattened into a CSR
+ * index: the pointers of all the entries back to back, plus the offset of
+ * the first pointer of each entry.
+ *
+ * @author cadams
+ */
+
+/** \addtogroup RecoViewer
+
+    @{*/
+#ifndef EVD_ASSOCIATIONCACHE_H
+#define EVD_ASSOCIATIONCACHE_H
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+#include <stdexcept>
+
+#include "gallery/Event.h"
+#include "gallery/ValidHandle.h"
+#include "canvas/Persistency/Common/Ptr.h"
+#include "canvas/Persistency/Common/FindManyP.h"
+#include "canvas/Utilities/InputTag.h"
+
+namespace evd {
+
+/**
+   \class PtrRange
+   View of the pointers associated with one entry, in the order FindManyP
+   gives them.  Nothing is copied, it is valid until the next event.
+ */
+template <class T>
+class PtrRange {
+
+public:
+
+  typedef typename std::vector<art::Ptr<T> >::const_iterator const_iterator;
+
+  PtrRange(const_iterator b, const_iterator e) : _begin(b), _end(e) {}
+
+  size_t size() const {return _end - _begin;}
+  bool empty() const {return _begin == _end;}
+  const_iterator begin() const {return _begin;}
+  const_iterator end() const {return _end;}
+  const art::Ptr<T> & operator[](size_t i) const {return _begin[i];}
+  const art::Ptr<T> & at(size_t i) const {
+    if (i >= size())
+      throw std::out_of_range("PtrRange::at");
+    return _begin[i];
+  }
+
+private:
+
+  const_iterator _begin;
+  const_iterator _end;
+
+};
+
+/// Type independent part of AssociationIndex, so the cache can own them all
+class AssociationIndexBase {
+
+public:
+
+  virtual ~AssociationIndexBase() {}
+
+};
+
+/**
+   \class AssociationIndex
+   Association from each entry of a product to pointers of type T, as CSR.
+ */
+template <class T>
+class AssociationIndex : public AssociationIndexBase {
+
+public:
+
+  /// Flatten a FindManyP
+  explicit AssociationIndex(const art::FindManyP<T> & find_many);
+
+  /// Number of entries of the first product
+  size_t size() const {return _offsets.size() - 1;}
+
+  /// Pointers associated with entry i
+  PtrRange<T> at(size_t i) const {
+    if (i >= size())
+      throw std::out_of_range("AssociationIndex::at");
+    return PtrRange<T>(_ptrs.begin() + _offsets[i], _ptrs.begin() + _offsets[i + 1]);
+  }
+
+private:
+
+  // Pointers of entry i are _ptrs[_offsets[i]] to _ptrs[_offsets[i+1] - 1]
+  std::vector<size_t> _offsets;
+  std::vector<art::Ptr<T> > _ptrs;
+
+};
+
+template <class T>
+AssociationIndex<T>::AssociationIndex(const art::FindManyP<T> & find_many)
+{
+  _offsets.reserve(find_many.size() + 1);
+  _offsets.push_back(0);
+  for (size_t i = 0; i < find_many.size(); i ++)
+    _offsets.push_back(_offsets.back() + find_many.at(i).size());
+
+  _ptrs.reserve(_offsets.back());
+  for (size_t i = 0; i < find_many.size(); i ++)
+    _ptrs.insert(_ptrs.end(), find_many.at(i).begin(), find_many.at(i).end());
+}
+
+/**
+   \class AssociationCache
+   Associations of the current event, keyed by the two product types and
+   the input tag of the association.
+ */
+class AssociationCache {
+
+public:
+
+  /// The cache shared by all the drawers
+  static AssociationCache & GetME();
+
+  ~AssociationCache();
+
+  /**
+   * @brief Association from the entries of handle to pointers of type T
+   * @details Resolved with FindManyP the first time it is asked for in an
+   *          event, then served from the cache.  The cache is cleared when
+   *          the event is not the one seen last, that is when the
+   *          gallery::Event, its file and entry, or its ID change (the
+   *          cached pointers belong to the gallery::Event that made them).
+   *          The key does not include the producer of handle, so the same
+   *          (types, tag) must always be asked for with the same product.
+   *
+   * @param ev The current event
+   * @param handle Product the association starts from
+   * @param tag Input tag of the association
+   */
+  template <class T, class U>
+  const AssociationIndex<T> & get(gallery::Event * ev,
+                                  const gallery::ValidHandle<std::vector<U> > & handle,
+                                  const art::InputTag & tag);
+
+private:
+
+  AssociationCache();
+
+  /// Clear the cache if this is a new event
+  void set_event(gallery::Event * ev);
+
+  void clear();
+
+  typedef std::tuple<std::type_index, std::type_index, std::string> cache_key;
+
+  // The event seen last
+  const gallery::Event * _event;
+  long long _file_entry;
+  long long _event_entry;
+  art::EventID _event_id;
+  bool _has_event;
+
+  std::map<cache_key, AssociationIndexBase *> _associations;
+
+};
+
+template <class T, class U>
+const AssociationIndex<T> & AssociationCache::get(gallery::Event * ev,
+                                                  const gallery::ValidHandle<std::vector<U> > & handle,
+                                                  const art::InputTag & tag)
+{
+  set_event(ev);
+
+  cache_key key(std::type_index(typeid(U)), std::type_index(typeid(T)), tag.encode());
+  AssociationIndexBase * & association = _associations[key];
+  if (!association)
+  {
+    art::FindManyP<T> find_many(handle, *ev, tag);
+    association = new AssociationIndex<T>(find_many);
+  }
+
+  return *static_cast<AssociationIndex<T> *>(association);
+}
+
+} // evd
+
+#endif
+/** @} */ // end of doxygen group
@@ -2,6 +2,7 @@
 #define EVD_DRAWCLUSTER_CXX
 
 #include "DrawCluster.h"
+#include "Base/messenger.h"
 
 namespace evd {
 
@@ -52,6 +53,8 @@ bool DrawCluster::analyze(gallery::Event * ev)
     // Obtain event-wise data object pointers
     //
   
+    _invalidateWindowIndex();
+
     // Clear out the hit data but reserve some space for the hits
     for (unsigned int p = 0; p < _geoService.Nplanes(); p ++) 
     {
@@ -69,7 +72,7 @@ bool DrawCluster::analyze(gallery::Event * ev)
   auto const & clusters = ev -> getValidHandle<std::vector <recob::Cluster> >(clusters_tag);
 
   if (clusters->size() == 0) {
-    std::cout << "No clusters found." << std::endl;
+    GALLERY_FMWK_MSG(galleryfmwk::msg::kINFO, __FUNCTION__, "No clusters found.");
     return false;
   }
 
@@ -78,7 +81,11 @@ bool DrawCluster::analyze(gallery::Event * ev)
 
   art::InputTag assn_tag(_producer);
 
-  art::FindMany<recob::Hit> hits_for_cluster(clusters, *ev, assn_tag);
+  auto const & hits_for_cluster = AssociationCache::GetME().get<recob::Hit>(ev, clusters, assn_tag);
+
+  // Hits are shared with the other drawers through the store:
+  HitStore & hit_store = HitStore::GetME();
+  hit_store.set_event(ev);
 
   for (unsigned int p = 0; p < _geoService.Nplanes(); p ++)
     _dataByPlane[p].reserve(clusters -> size());
@@ -113,8 +120,8 @@ bool DrawCluster::analyze(gallery::Event * ev)
     // Set the params:
     // _dataByPlane[plane].back()._params = params;
 
-    std::vector<recob::Hit const*> hits;
-    hits_for_cluster.get(index, hits);
+    auto const hits = hits_for_cluster.at(index);
+    _dataByPlane[plane].back().reserve(hits.size());
 
     for (auto const& hit : hits) 
     {
@@ -128,17 +135,7 @@ bool DrawCluster::analyze(gallery::Event * ev)
       // }
       // Hit(float w, float t, float c, float r) :
 
-      _dataByPlane[plane].back().emplace_back(
-        Hit2D(hit->WireID().Wire,
-              hit->PeakTime(),
-              hit->Integral(),
-              hit->RMS(),
-              hit->StartTick(),
-              hit->PeakTime(),
-              hit->EndTick(),
-              hit->PeakAmplitude(),
-              plane
-             ));
+      _dataByPlane[plane].back().push_back(hit_store.index(hit));
 
 
       // Determine if this hit should change the view range:
@@ -22,6 +22,8 @@
 #include "canvas/Persistency/Common/FindManyP.h"
 
 #include "DrawHit.h"
+#include "HitStore.h"
+#include "AssociationCache.h"
 
 
 
@@ -31,7 +33,8 @@ namespace evd {
    User custom analysis class made by SHELL_USER_NAME
  */
 
-class Cluster2D : public std::vector<evd::Hit2D> {
+/// Hits of a cluster, as indices into the HitStore of the event
+class Cluster2D : public HitIndexList {
 
 public:
   Cluster2D() {_is_good = false;}
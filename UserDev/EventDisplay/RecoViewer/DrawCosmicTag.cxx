@@ -5,23 +5,24 @@
 
 namespace evd {
 
-CosmicTag DrawCosmicTag::getTrack2D(recob::Track track, unsigned int plane) {
+CosmicTag DrawCosmicTag::getTrack2D(const recob::Track & track, unsigned int plane) {
     CosmicTag result;
 
-    result._track.reserve(track.NumberTrajectoryPoints());
+    // Collect the valid points, then project them all at once:
+    Points3D points;
+    points.reserve(track.NumberTrajectoryPoints());
     for (unsigned int i = 0; i < track.NumberTrajectoryPoints(); i++) 
     {
-        // project a point into 2D:
         try {
 	         if (track.HasValidPoint(i)) {
 	             auto loc = track.LocationAtPoint(i);
-	             auto point = Point_3Dto2D(loc.X(), loc.Y(), loc.Z() , plane);
-	             result._track.push_back(std::make_pair(point.w, point.t));
+	             points.push_back(loc.X(), loc.Y(), loc.Z());
 	         }
         } catch (...) {
 	         continue;
         }
     }
+    Points_3Dto2D(points, plane, result._track);
     
     return result;
 }
@@ -66,6 +67,8 @@ bool DrawCosmicTag::analyze(gallery::Event *ev)
 
   }
 
+  _invalidateWindowIndex();
+
   // Clear out the data but reserve some space for the tracks
   for (unsigned int p = 0; p < _geoService.Nplanes(); p++) 
   {
@@ -63,7 +63,7 @@ public:
   virtual bool finalize();
 
 private:
-  CosmicTag getTrack2D(recob::Track track, unsigned int plane);
+  CosmicTag getTrack2D(const recob::Track & track, unsigned int plane);
 };
 
 } // evd
@@ -27,6 +27,17 @@ bool DrawEndpoint::initialize() {
   return true;
 }
 
+std::vector<std::string> DrawEndpoint::resources() const
+{
+  return std::vector<std::string>(1, "recob::EndPoint2D:" + _producer);
+}
+
+bool DrawEndpoint::prefetch(gallery::Event * ev)
+{
+  ev->getValidHandle<std::vector <recob::EndPoint2D> >(art::InputTag(_producer));
+  return true;
+}
+
 bool DrawEndpoint::analyze(gallery::Event * ev) 
 {
     //
@@ -54,6 +65,8 @@ bool DrawEndpoint::analyze(gallery::Event * ev)
     art::InputTag end2d_tag(_producer);
     auto const & end2dHandle = ev->getValidHandle<std::vector <recob::EndPoint2D> >(end2d_tag);
   
+    _invalidateWindowIndex();
+
     // Clear out the data but reserve some space
     for (unsigned int plane = 0; plane < _geoService.Nplanes(); plane++) 
     {
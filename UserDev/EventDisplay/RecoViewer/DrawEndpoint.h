@@ -38,6 +38,8 @@ public:
   float charge()   {return _charge;}
   float strength() {return _strength;}
 
+  Box2D boundingBox() const {return Box2D(_wire, _wire, _time, _time);}
+
 private:
   float _wire;
   float _time;
@@ -70,6 +72,11 @@ public:
   */
   virtual bool analyze(gallery::Event * event);
 
+  /// Reads one product, see anabase::resources
+  virtual std::vector<std::string> resources() const;
+
+  virtual bool prefetch(gallery::Event * event);
+
   /** IMPLEMENT in DrawEndpoint.cc!
       Finalize method to be called after all events processed.
   */
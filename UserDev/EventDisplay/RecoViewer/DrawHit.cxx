@@ -2,9 +2,45 @@
 #define EVD_DRAWHIT_CXX
 
 #include "DrawHit.h"
+#include "Base/messenger.h"
+#include "TString.h"
+
+#include <algorithm>
 
 namespace evd {
 
+void HitColumns::clear()
+{
+    wire.clear();
+    peak_time.clear();
+    rms.clear();
+    charge.clear();
+    peak_amplitude.clear();
+    start_time.clear();
+    end_time.clear();
+}
+
+void HitColumns::reserve(size_t n)
+{
+    wire.reserve(n);
+    peak_time.reserve(n);
+    rms.reserve(n);
+    charge.reserve(n);
+    peak_amplitude.reserve(n);
+    start_time.reserve(n);
+    end_time.reserve(n);
+}
+
+void HitColumns::push_back(const Hit2D & hit)
+{
+    wire.push_back(hit._wire);
+    peak_time.push_back(hit._peak_time);
+    rms.push_back(hit._rms);
+    charge.push_back(hit._charge);
+    peak_amplitude.push_back(hit._peak_amplitude);
+    start_time.push_back(hit._start_time);
+    end_time.push_back(hit._end_time);
+}
 
 DrawHit::DrawHit(const geo::GeometryCore& geometry, const detinfo::DetectorProperties& detectorProperties) :
     RecoBase(geometry,detectorProperties)
@@ -20,11 +56,24 @@ bool DrawHit::initialize()
     if (_dataByPlane.size() != _geoService.Nplanes()) 
     {
         _dataByPlane.resize(_geoService.Nplanes());
+        _columnsByPlane.resize(_geoService.Nplanes());
+        _wireOffsetsByPlane.resize(_geoService.Nplanes());
         _maxCharge.resize(_geoService.Nplanes());
     }
     return true;
 }
 
+std::vector<std::string> DrawHit::resources() const
+{
+    return std::vector<std::string>(1, "recob::Hit:" + _producer);
+}
+
+bool DrawHit::prefetch(gallery::Event * ev)
+{
+    ev->getValidHandle<std::vector <recob::Hit> >(art::InputTag(_producer));
+    return true;
+}
+
 bool DrawHit::analyze(gallery::Event* ev) 
 {
     //
@@ -49,8 +98,11 @@ bool DrawHit::analyze(gallery::Event* ev)
     art::InputTag hits_tag(_producer);
     auto const & hitHandle = ev -> getValidHandle<std::vector <recob::Hit> >(hits_tag);
 
-    std::cout << "***** recovering data for hits, input: " << hits_tag << ", size: " << hitHandle->size() << std::endl;
+    GALLERY_FMWK_MSG(galleryfmwk::msg::kINFO, __FUNCTION__,
+                     Form("Hits of %s: %zu", _producer.c_str(), hitHandle->size()));
   
+    _invalidateWindowIndex();
+
     // Clear out the hit data but reserve some space for the hits
     for (unsigned int p = 0; p < _geoService.Nplanes(); p ++) 
     {
@@ -97,9 +149,48 @@ bool DrawHit::analyze(gallery::Event* ev)
         // hitEndByPlane -> at(view).push_back(hit.PeakTime() + hit.RMS());
     }
 
+    for (unsigned int p = 0; p < _geoService.Nplanes(); p ++)
+        sortByWire(p);
+
   return true;
 }
 
+void DrawHit::sortByWire(size_t plane)
+{
+    std::vector<Hit2D> & hits = _dataByPlane[plane];
+    std::vector<size_t> & offsets = _wireOffsetsByPlane[plane];
+
+    size_t n_wires = _geoService.Nwires(plane);
+    for (auto & hit : hits)
+        n_wires = std::max(n_wires, size_t(hit.wire()) + 1);
+
+    // Count the hits on each wire, the running sum is where each wire starts:
+    offsets.assign(n_wires + 1, 0);
+    for (auto & hit : hits)
+        offsets[size_t(hit.wire()) + 1] ++;
+    for (size_t w = 0; w < n_wires; w ++)
+        offsets[w + 1] += offsets[w];
+
+    // Place every hit in the block of its wire, then sort each block by time:
+    std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+    _sortScratch.resize(hits.size());
+    for (auto & hit : hits)
+        _sortScratch[next[size_t(hit.wire())] ++] = hit;
+    hits.swap(_sortScratch);
+
+    for (size_t w = 0; w < n_wires; w ++)
+    {
+        std::sort(hits.begin() + offsets[w], hits.begin() + offsets[w + 1],
+                  [](const Hit2D & a, const Hit2D & b) {return a._time < b._time;});
+    }
+
+    HitColumns & columns = _columnsByPlane[plane];
+    columns.clear();
+    columns.reserve(hits.size());
+    for (auto & hit : hits)
+        columns.push_back(hit);
+}
+
 float DrawHit::maxCharge(size_t p) 
 {
     if (p >= _geoService.Nplanes() ) 
@@ -130,15 +221,106 @@ std::vector<Hit2D> DrawHit::getHitsOnWirePlane(size_t wire, size_t plane)
     }
     else 
     {
-        for (auto & hit : _dataByPlane.at(plane)) {
-            if (hit.wire() == wire)
-                result.emplace_back(hit);
-        }
+        std::pair<size_t, size_t> range = getHitRangeOnWire(wire, plane);
+        result.assign(_dataByPlane.at(plane).begin() + range.first,
+                      _dataByPlane.at(plane).begin() + range.second);
     }
 
   return result;
 }
 
+std::pair<size_t, size_t> DrawHit::getHitRangeOnWire(size_t wire, size_t plane) const
+{
+    return getHitRangeOnWires(wire, wire + 1, plane);
+}
+
+std::pair<size_t, size_t> DrawHit::getHitRangeOnWires(size_t wire_start, size_t wire_end, size_t plane) const
+{
+    if (plane >= _wireOffsetsByPlane.size())
+    {
+        std::cerr << "ERROR: Request for nonexistent plane " << plane << std::endl;
+        return std::make_pair(0, 0);
+    }
+
+    const std::vector<size_t> & offsets = _wireOffsetsByPlane[plane];
+    if (offsets.empty())
+        return std::make_pair(0, 0);
+
+    // Wires past the last one have no hits:
+    size_t n_wires = offsets.size() - 1;
+    wire_start = std::min(wire_start, n_wires);
+    wire_end = std::max(wire_start, std::min(wire_end, n_wires));
+
+    return std::make_pair(offsets[wire_start], offsets[wire_end]);
+}
+
+const HitColumns & DrawHit::getColumnsByPlane(size_t plane) const
+{
+    static HitColumns returnNull;
+    if (plane >= _columnsByPlane.size())
+    {
+        std::cerr << "ERROR: Request for nonexistent plane " << plane << std::endl;
+        return returnNull;
+    }
+    return _columnsByPlane[plane];
+}
+
+PyObject* DrawHit::getHitColumnsByPlane(size_t plane)
+{
+    if (plane >= _columnsByPlane.size())
+    {
+        std::cerr << "ERROR: Request for nonexistent plane " << plane << std::endl;
+        Py_RETURN_NONE;
+    }
+
+    return columnsToNumpy(plane, 0, _columnsByPlane[plane].size());
+}
+
+PyObject* DrawHit::getHitColumnsOnWires(size_t wire_start, size_t wire_end, size_t plane)
+{
+    if (plane >= _columnsByPlane.size())
+    {
+        std::cerr << "ERROR: Request for nonexistent plane " << plane << std::endl;
+        Py_RETURN_NONE;
+    }
+
+    std::pair<size_t, size_t> range = getHitRangeOnWires(wire_start, wire_end, plane);
+    return columnsToNumpy(plane, range.first, range.second);
+}
+
+PyObject* DrawHit::columnsToNumpy(size_t plane, size_t begin, size_t end)
+{
+    // Imported here rather than in the constructor, so that DrawHit can be
+    // used from C++ without a python interpreter
+    static const bool numpy_imported = (_import_array() >= 0);
+    if (!numpy_imported) return nullptr;
+
+    HitColumns & columns = _columnsByPlane[plane];
+
+    std::pair<const char *, std::vector<float> *> named_columns[] = {
+        {"wire",           &columns.wire},
+        {"peak_time",      &columns.peak_time},
+        {"rms",            &columns.rms},
+        {"charge",         &columns.charge},
+        {"peak_amplitude", &columns.peak_amplitude},
+        {"start_time",     &columns.start_time},
+        {"end_time",       &columns.end_time}
+    };
+
+    PyObject* result = PyDict_New();
+    long int dims[1];
+    dims[0] = end - begin;
+    for (auto & named_column : named_columns)
+    {
+        PyObject* array = PyArray_SimpleNewFromData(1, dims, NPY_FLOAT, named_column.second->data() + begin);
+        // The dict takes its own reference:
+        PyDict_SetItemString(result, named_column.first, array);
+        Py_DECREF(array);
+    }
+
+    return result;
+}
+
 
 bool DrawHit::finalize() {
 
@@ -55,15 +55,44 @@ public:
     float _peak_amplitude;
     int   _plane;
 
-    float wire()   {return _wire;}
-    float time()   {return _time;}
-    float charge() {return _charge;}
-    float rms()    {return _rms;}
-    float start_time()  {return _start_time;}
-    float peak_time()   {return _peak_time;}
-    float end_time()    {return _end_time;}
-    float peak_amplitude()  {return _peak_amplitude;}
-    int   plane()  {return _plane;}
+    float wire()   const {return _wire;}
+    float time()   const {return _time;}
+    float charge() const {return _charge;}
+    float rms()    const {return _rms;}
+    float start_time()  const {return _start_time;}
+    float peak_time()   const {return _peak_time;}
+    float end_time()    const {return _end_time;}
+    float peak_amplitude()  const {return _peak_amplitude;}
+    int   plane()  const {return _plane;}
+
+    /// One wire wide, from the start to the end of the hit in ticks
+    Box2D boundingBox() const {
+        return Box2D(_wire, _wire + 1,
+                     std::min(_start_time, _peak_time - _rms),
+                     std::max(_end_time, _peak_time + _rms));
+    }
+};
+
+/**
+ * @brief Hits of one plane stored column by column
+ * @details Entry i of every column belongs to the same hit, so each column
+ *          is a contiguous array that can be handed to numpy without a copy.
+ */
+class HitColumns {
+
+public:
+    void clear();
+    void reserve(size_t n);
+    void push_back(const Hit2D & hit);
+    size_t size() const {return wire.size();}
+
+    std::vector<float> wire;
+    std::vector<float> peak_time;
+    std::vector<float> rms;
+    std::vector<float> charge;
+    std::vector<float> peak_amplitude;
+    std::vector<float> start_time;
+    std::vector<float> end_time;
 };
 
 class DrawHit : public galleryfmwk::anabase, public RecoBase<Hit2D> 
@@ -87,6 +116,11 @@ public:
     */
     virtual bool analyze(gallery::Event* event);
 
+    /// Reads one product, see anabase::resources
+    virtual std::vector<std::string> resources() const;
+
+    virtual bool prefetch(gallery::Event * event);
+
     /** IMPLEMENT in DrawCluster.cc!
         Finalize method to be called after all events processed.
     */
@@ -94,12 +128,74 @@ public:
 
     float maxCharge(size_t plane);
 
+    /// Copy of the hits on one wire, sorted by time
     std::vector<Hit2D> getHitsOnWirePlane(size_t wire, size_t plane);
 
+    /**
+     * @brief Index range [first, second) of the hits on one wire
+     * @details After analyze the hits of each plane (in getDataByPlane and in
+     *          the columns) are sorted by wire, then time, so the hits of a
+     *          wire are contiguous.  This is a lookup in the wire offset
+     *          table, nothing is copied.
+     *
+     * @param wire Wire number
+     * @param plane Plane number
+     */
+    std::pair<size_t, size_t> getHitRangeOnWire(size_t wire, size_t plane) const;
+
+    /**
+     * @brief Index range [first, second) of the hits on wires [wire_start, wire_end)
+     *
+     * @param wire_start First wire of the range
+     * @param wire_end One past the last wire of the range
+     * @param plane Plane number
+     */
+    std::pair<size_t, size_t> getHitRangeOnWires(size_t wire_start, size_t wire_end, size_t plane) const;
+
+    /// Hits of this plane as columns, see HitColumns
+    const HitColumns & getColumnsByPlane(size_t plane) const;
+
+    /**
+     * @brief Hits of this plane as a dict of 1D numpy float arrays
+     * @details Keys are wire, peak_time, rms, charge, peak_amplitude,
+     *          start_time and end_time.  The arrays are views of the columns
+     *          stored here, without a copy, and are only valid until the
+     *          next call to analyze.
+     *
+     * @param plane Plane number
+     * @return New dict, or None for a nonexistent plane
+     */
+    PyObject * getHitColumnsByPlane(size_t plane);
+
+    /**
+     * @brief Hits on wires [wire_start, wire_end) as a dict of numpy arrays
+     * @details Same keys as getHitColumnsByPlane.  The arrays are views of a
+     *          slice of the plane columns, without a copy.
+     *
+     * @param wire_start First wire of the range
+     * @param wire_end One past the last wire of the range
+     * @param plane Plane number
+     * @return New dict, or None for a nonexistent plane
+     */
+    PyObject * getHitColumnsOnWires(size_t wire_start, size_t wire_end, size_t plane);
+
 private:
 
+    /// Sort the hits of a plane by wire and time and fill the wire offset table
+    void sortByWire(size_t plane);
+
+    /// Dict of numpy views of the column entries [begin, end) of a plane
+    PyObject * columnsToNumpy(size_t plane, size_t begin, size_t end);
+
     std::vector <float> _maxCharge;
 
+    std::vector <HitColumns> _columnsByPlane;
+
+    // Hits of wire w are entries [_wireOffsetsByPlane[p][w], _wireOffsetsByPlane[p][w+1])
+    std::vector <std::vector<size_t> > _wireOffsetsByPlane;
+
+    std::vector <Hit2D> _sortScratch;
+
 };
 
 } // evd
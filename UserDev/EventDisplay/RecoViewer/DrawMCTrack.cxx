@@ -2,28 +2,33 @@
 #define EVD_DRAWMCTRACK_CXX
 
 #include "DrawMCTrack.h"
+#include "Base/messenger.h"
+#include "TString.h"
 
 namespace evd {
 
-MCTrack2D DrawMCTrack::getMCTrack2D(simb::MCParticle track, unsigned int plane) {
+MCTrack2D DrawMCTrack::getMCTrack2D(const simb::MCParticle & track, unsigned int plane) {
   MCTrack2D result;
   result._track.reserve(track.NumberTrajectoryPoints());
   auto vtxtrk = track.Position(0);
   if (plane == 2) {
-    std::cout << "Particle with PDG " << track.PdgCode() << std::endl;
-    std::cout << "\t with " << track.NumberTrajectoryPoints() << " points and vertex @ " 
-	      << "[ " << vtxtrk.X() << ", " << vtxtrk.Y() << ", " << vtxtrk.Z() << " ]" << std::endl;
+    GALLERY_FMWK_DEBUG(__FUNCTION__, Form("Particle with PDG %d with %u points and vertex @ [ %g, %g, %g ]",
+                                          track.PdgCode(), track.NumberTrajectoryPoints(),
+                                          vtxtrk.X(), vtxtrk.Y(), vtxtrk.Z()));
   }
+  // Collect the points, then project them all at once:
+  Points3D points;
+  points.reserve(track.NumberTrajectoryPoints());
   for (unsigned int i = 0; i < track.NumberTrajectoryPoints(); i++) {
-    // project a point into 2D:
     try {
       auto pointtrk = track.Position(i);
-      auto point = Point_3Dto2D(pointtrk.X(), pointtrk.Y(), pointtrk.Z(), plane);
-      result._track.push_back(std::make_pair(point.w, point.t));
+      points.push_back(pointtrk.X(), pointtrk.Y(), pointtrk.Z());
     } catch (...) {
       continue;
     }
   }
+  Points_3Dto2D(points, plane, result._track);
+  result.computeLevelOfDetail();
 
   //result._origin = track.Origin();
 
@@ -46,6 +51,17 @@ bool DrawMCTrack::initialize() {
   return true;
 }
 
+std::vector<std::string> DrawMCTrack::resources() const
+{
+  return std::vector<std::string>(1, "simb::MCParticle:" + _producer);
+}
+
+bool DrawMCTrack::prefetch(gallery::Event * ev)
+{
+  ev->getValidHandle<std::vector<simb::MCParticle> >(art::InputTag(_producer));
+  return true;
+}
+
 bool DrawMCTrack::analyze(gallery::Event *ev) 
 {
   //
@@ -71,6 +87,8 @@ bool DrawMCTrack::analyze(gallery::Event *ev)
 
   //std::cout << "there are " << trackHandle->size() << " mctracks" << std::endl;
 
+  _invalidateWindowIndex();
+
   // Clear out the data but reserve some space for the tracks
   for (unsigned int p = 0; p < _geoService.Nplanes(); p++) 
   {
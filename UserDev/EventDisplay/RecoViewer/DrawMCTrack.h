@@ -55,10 +55,15 @@ public:
 
   virtual bool analyze(gallery::Event *event);
 
+  /// Reads one product, see anabase::resources
+  virtual std::vector<std::string> resources() const;
+
+  virtual bool prefetch(gallery::Event * event);
+
   virtual bool finalize();
 
 private:
-  MCTrack2D getMCTrack2D(simb::MCParticle track, unsigned int plane);
+  MCTrack2D getMCTrack2D(const simb::MCParticle & track, unsigned int plane);
 };
 
 } // evd
@@ -2,6 +2,9 @@
 #define EVD_DRAWNUMUSELECTION_CXX
 
 #include "DrawNumuSelection.h"
+#include "Base/messenger.h"
+#include "TString.h"
+#include "AssociationCache.h"
 
 #include "canvas/Persistency/Common/FindManyP.h"
 #include "art/Persistency/Common/PtrMaker.h"
@@ -20,7 +23,7 @@ NumuSelection2D DrawNumuSelection::getNumuSelection2D(const recob::Vertex vtx,co
     double pos[3];
     vtx.XYZ(pos);
     if (plane == 2)
-      std::cout << "vtx : [ " << pos[0] << ", " << pos[1] << ", " << pos[2] << "  ]" << std::endl;
+      GALLERY_FMWK_DEBUG(__FUNCTION__, Form("vtx : [ %g, %g, %g ]", pos[0], pos[1], pos[2]));
     auto point = Point_3Dto2D(pos[0], pos[1], pos[2], plane);
     result._vertex = point;
   } catch (...) {
@@ -31,20 +34,22 @@ NumuSelection2D DrawNumuSelection::getNumuSelection2D(const recob::Vertex vtx,co
   std::vector<Track2D> track_v;
   track_v.reserve(tracks.size());
   for (size_t t = 0; t < tracks.size(); t++) {
-    auto trk = tracks.at(t);
+    auto const& trk = tracks.at(t);
     Track2D trk_out;
-    trk_out._track.reserve(trk.NumberTrajectoryPoints());
+    // Collect the valid points, then project them all at once:
+    Points3D points;
+    points.reserve(trk.NumberTrajectoryPoints());
     for (unsigned int i = 0; i < trk.NumberTrajectoryPoints(); i++) {
       try {
         if (trk.HasValidPoint(i)) {
 	         auto loc = trk.LocationAtPoint(i);
-           auto point = Point_3Dto2D(loc.X(), loc.Y(), loc.Z(), plane);
-           trk_out._track.push_back(std::make_pair(point.w, point.t));
+           points.push_back(loc.X(), loc.Y(), loc.Z());
         }
       } catch (...) {
         continue;
       }
     }
+    Points_3Dto2D(points, plane, trk_out._track);
     track_v.emplace_back(trk_out);
 
     // the longest track is the muon
@@ -64,8 +69,8 @@ NumuSelection2D DrawNumuSelection::getNumuSelection2D(const recob::Vertex vtx,co
     auto mustart = tracks.at(muon_index).Vertex();
     auto muend   = tracks.at(muon_index).End();
     if (plane == 2) {
-      std::cout << "muon start : [ " << mustart.X() << ", " << mustart.Y() << ", " << mustart.Z() << " ]" << std::endl;
-      std::cout << "muon end   : [ " << muend.X()   << ", " << muend.Y()   << ", " << muend.Z()   << " ]" << std::endl;
+      GALLERY_FMWK_DEBUG(__FUNCTION__, Form("muon start : [ %g, %g, %g ]", mustart.X(), mustart.Y(), mustart.Z()));
+      GALLERY_FMWK_DEBUG(__FUNCTION__, Form("muon end   : [ %g, %g, %g ]", muend.X(), muend.Y(), muend.Z()));
     }
   }
 
@@ -76,6 +81,16 @@ NumuSelection2D DrawNumuSelection::getNumuSelection2D(const recob::Vertex vtx,co
   return result;
 }
 
+Box2D NumuSelection2D::boundingBox() const
+{
+  Box2D box = _vertex.boundingBox();
+  for (auto const & track : _tracks)
+    box.extend(track.boundingBox());
+  for (auto const & shower : _showers)
+    box.extend(shower.boundingBox());
+  return box;
+}
+
 DrawNumuSelection::DrawNumuSelection(const geo::GeometryCore& geometry, const detinfo::DetectorProperties& detectorProperties) :
     RecoBase(geometry, detectorProperties)
 {
@@ -98,7 +113,9 @@ bool DrawNumuSelection::analyze(gallery::Event *ev)
 
   // get vertices and pfparticles associated just so that we have the PFP art::Ptrs
   auto const& vtxHandle =  ev -> getValidHandle<std::vector <recob::Vertex> >(pfp_tag);
-  art::FindManyP<recob::PFParticle> vtx_pfp_assn_v(vtxHandle, *ev, pfp_tag);
+  // Associations are resolved once per event and shared with the other drawers:
+  AssociationCache & associations = AssociationCache::GetME();
+  auto const& vtx_pfp_assn_v = associations.get<recob::PFParticle>(ev, vtxHandle, pfp_tag);
 
   // get a handle to the showers
   auto const& pfpHandle =  ev -> getValidHandle<std::vector <recob::PFParticle> >(pfp_tag);
@@ -123,29 +140,47 @@ bool DrawNumuSelection::analyze(gallery::Event *ev)
   
   // grab tracks associated with PFParticles
   art::InputTag trk_tag(_producer);
-  art::FindMany<recob::Track>  pfp_track_assn_v (pfpHandle, *ev, trk_tag);
+  auto const& pfp_track_assn_v = associations.get<recob::Track>(ev, pfpHandle, trk_tag);
 
   // grab vertices associated with PFParticles
   art::InputTag vtx_tag(_producer);
-  art::FindMany<recob::Vertex> pfp_vertex_assn_v(pfpHandle, *ev, vtx_tag);
+  auto const& pfp_vertex_assn_v = associations.get<recob::Vertex>(ev, pfpHandle, vtx_tag);
   
   // grab clusters associated with PFParticles
   art::InputTag clus_tag(_producer);
-  art::FindManyP<recob::Cluster> pfp_clus_assn_v(pfpHandle, *ev, clus_tag);
+  auto const& pfp_clus_assn_v = associations.get<recob::Cluster>(ev, pfpHandle, clus_tag);
   // grab clusters themselves
   auto const& clusHandle = ev->getValidHandle<std::vector<recob::Cluster> >(clus_tag);
   // get hits associated to clusters
-  art::FindMany<recob::Hit> clus_hit_assn_v(clusHandle, *ev, clus_tag);
+  auto const& clus_hit_assn_v = associations.get<recob::Hit>(ev, clusHandle, clus_tag);
   
   // grab showers associated with PFParticles
-  art::FindMany<recob::Shower> pfp_shower_assn_v(pfpHandle, *ev, pfp_tag);
+  auto const& pfp_shower_assn_v = associations.get<recob::Shower>(ev, pfpHandle, pfp_tag);
 
   // grab slice associated to slices
-  art::FindManyP<recob::Slice> pfp_slice_assn_v(pfpHandle, *ev, pfp_tag);
+  auto const& pfp_slice_assn_v = associations.get<recob::Slice>(ev, pfpHandle, pfp_tag);
   // grab slices themselves
   auto const& sliceHandle = ev->getValidHandle<std::vector<recob::Slice> >(pfp_tag);
   // grab hits associated to slices
-  art::FindMany<recob::Hit> slice_hit_assn_v(sliceHandle, *ev, pfp_tag);
+  auto const& slice_hit_assn_v = associations.get<recob::Hit>(ev, sliceHandle, pfp_tag);
+
+  // Hits are shared with the other drawers through the store:
+  HitStore & hit_store = HitStore::GetME();
+  hit_store.set_event(ev);
+
+  // The hit indices of the last event's selection point into the old store,
+  // so they are cleared before anything can return
+  _invalidateWindowIndex();
+
+  // Clear out the data but reserve some space for the tracks
+  for (unsigned int p = 0; p < _geoService.Nplanes(); p++) {
+    _dataByPlane[p].clear();
+    _dataByPlane[p].reserve(1.);
+    _wireRange[p].first = 99999;
+    _timeRange[p].first = 99999;
+    _timeRange[p].second = -1.0;
+    _wireRange[p].second = -1.0;
+  }
 
   //art::PtrMaker<recob::PFParticle> PFPPtrMaker(e);
 
@@ -190,12 +225,12 @@ bool DrawNumuSelection::analyze(gallery::Event *ev)
       for (size_t si=0; si < pfp_slice_ass.size(); si++) {
 	// grab slice index
 	slicekey = pfp_slice_ass[si].key();
-	std::cout << "slice key is " << slicekey << std::endl;
+	GALLERY_FMWK_DEBUG(__FUNCTION__, Form("slice key is %zu", slicekey));
       }// for all slices associated to PFP
 
       auto ass_vtx_v  =pfp_vertex_assn_v.at( p );
       if (ass_vtx_v.size() != 1) 
-	std::cout << "ERROR. Neutrino not associated with a single vertex..." << std::endl;
+	galleryfmwk::Message::send(galleryfmwk::msg::kERROR, __FUNCTION__, "Neutrino not associated with a single vertex...");
       nuvtx = *(ass_vtx_v.at(0));
       
       auto daughters = pfp.Daughters();
@@ -203,7 +238,7 @@ bool DrawNumuSelection::analyze(gallery::Event *ev)
       for(auto const& daughterid : daughters) {
 	
 	if (_pfpmap.find(daughterid) == _pfpmap.end()) {
-	  std::cout << "Did not find DAUGHTERID in map! error"<< std::endl;
+	  galleryfmwk::Message::send(galleryfmwk::msg::kERROR, __FUNCTION__, "Did not find DAUGHTERID in map!");
 	  continue;
 	}
 	
@@ -236,40 +271,20 @@ bool DrawNumuSelection::analyze(gallery::Event *ev)
   
   if (neutrinos != 1) return true;
 
-  // Clear out the data but reserve some space for the tracks
-  for (unsigned int p = 0; p < _geoService.Nplanes(); p++) {
-    _dataByPlane[p].clear();
-    _dataByPlane[p].reserve(1.);
-    _wireRange[p].first = 99999;
-    _timeRange[p].first = 99999;
-    _timeRange[p].second = -1.0;
-    _wireRange[p].second = -1.0;
-  }
-
   for (unsigned int plane = 0; plane < _geoService.Nplanes(); plane++) {
     _dataByPlane[plane].push_back(this->getNumuSelection2D(nuvtx, sliceTracks, sliceShowers, plane));
     _dataByPlane[plane].back()._hits_v.resize(sliceHitIdx.size());
   }
 
   // grab slice -> hit ass vector
-  std::cout << "slice key is " << slicekey << std::endl;
+  GALLERY_FMWK_DEBUG(__FUNCTION__, Form("slice key is %zu", slicekey));
   auto slice_hit_ass = slice_hit_assn_v.at(slicekey);
   // loop through slice hits and add to display
   for (size_t slicehitidx = 0; slicehitidx < slice_hit_ass.size(); slicehitidx++) {
     
-    auto hit = *(slice_hit_ass.at(slicehitidx));
-    unsigned int plane = hit.WireID().Plane;
-    _dataByPlane[plane].back()._slice_hits.emplace_back(
-							  Hit2D(hit.WireID().Wire,
-								hit.PeakTime(),
-								hit.Integral(),
-								hit.RMS(),
-								hit.StartTick(),
-								hit.PeakTime(),
-								hit.EndTick(),
-								hit.PeakAmplitude(),
-								plane
-								));
+    auto const& hit = slice_hit_ass.at(slicehitidx);
+    unsigned int plane = hit->WireID().Plane;
+    _dataByPlane[plane].back()._slice_hits.push_back(hit_store.index(hit));
     
   }// for all slice-hits
   
@@ -280,19 +295,9 @@ bool DrawNumuSelection::analyze(gallery::Event *ev)
     auto const& ass_hits = clus_hit_assn_v.at(assidx);
     //auto const& ass_hits = pfp_hit_assn_v.at(assidx);
     for (size_t hitidx=0; hitidx < ass_hits.size(); hitidx++) {
-      auto hit = *(ass_hits.at(hitidx));
-      unsigned int view = hit.View();
-      _dataByPlane.at(view).back()._hits_v[si].emplace_back(
-							    Hit2D(hit.WireID().Wire,
-								  hit.PeakTime(),
-								  hit.Integral(),
-								  hit.RMS(),
-								  hit.StartTick(),
-								  hit.PeakTime(),
-								  hit.EndTick(),
-								  hit.PeakAmplitude(),
-								  view
-								  ));
+      auto const& hit = ass_hits.at(hitidx);
+      unsigned int view = hit->View();
+      _dataByPlane.at(view).back()._hits_v[si].push_back(hit_store.index(hit));
     }// for all hits associated to this PFP
   }// for all pfp -> hit association indices
   
@@ -41,20 +41,23 @@ public:
   const std::vector<Track2D> &tracks() { return _tracks; }
   const std::vector<Shower2D> &showers() { return _showers; }
   const Vertex2D &vertex() { return _vertex; }
-  const std::vector< std::vector<Hit2D> > &hits() { return _hits_v; }
-  const std::vector<Hit2D> &slicehits() { return _slice_hits; }
+  const std::vector<HitIndexList> &hits() { return _hits_v; }
+  const HitIndexList &slicehits() { return _slice_hits; }
 
   size_t muon_index(){return _muon_index;}
   const Track2D & muon(){return _tracks.at(_muon_index);}
 
+  /// Box around the tracks, showers and vertex, in cm (the hits are not included)
+  Box2D boundingBox() const;
+
 
 protected:
   std::vector<Track2D> _tracks;
   std::vector<Shower2D> _showers;
   Vertex2D _vertex;
   size_t _muon_index;
-  std::vector< std::vector<Hit2D> > _hits_v;
-  std::vector< Hit2D > _slice_hits;
+  std::vector<HitIndexList> _hits_v;
+  HitIndexList _slice_hits;
 
 };
 
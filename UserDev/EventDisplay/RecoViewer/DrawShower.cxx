@@ -2,9 +2,25 @@
 #define EVD_DRAWSHOWER_CXX
 
 #include "DrawShower.h"
+#include "Base/messenger.h"
+#include "TString.h"
+
+#include <cmath>
 
 namespace evd {
 
+Box2D Shower2D::boundingBox() const
+{
+  Box2D box;
+  box.extend(_startPoint.w, _startPoint.t);
+  // The cone is as wide as this at the end point (see shower.py)
+  float dw = _endPoint.w - _startPoint.w;
+  float dt = _endPoint.t - _startPoint.t;
+  float radius = std::sqrt(dw * dw + dt * dt) * std::tan(0.5 * _openingAngle);
+  box.extend(_endPoint.w - radius, _endPoint.t - radius);
+  box.extend(_endPoint.w + radius, _endPoint.t + radius);
+  return box;
+}
 
 DrawShower::DrawShower(const geo::GeometryCore& geometry, const detinfo::DetectorProperties& detectorProperties)
   : RecoBase<Shower2D>(geometry,detectorProperties)
@@ -32,14 +48,15 @@ bool DrawShower::analyze(gallery::Event * ev) {
 
   // draw associated hits too
   art::InputTag assn_tag(_producer);
-  art::FindMany<recob::Hit> hits_for_shower(showerHandle, *ev, assn_tag);
+  auto const & hits_for_shower = AssociationCache::GetME().get<recob::Hit>(ev, showerHandle, assn_tag);
 
-  if (showerHandle->size() == 0) {
-    std::cout << "No showers available to draw by producer "
-              << _producer
-              << std::endl;
-    return true;
-  }
+  // Hits are shared with the other drawers through the store:
+  HitStore & hit_store = HitStore::GetME();
+  hit_store.set_event(ev);
+
+  // The hit indices of the last event's showers point into the old store,
+  // so they are cleared before anything can return
+  _invalidateWindowIndex();
 
   // Clear out the hit data but reserve some space for the showers
   for (unsigned int p = 0; p < _geoService.Nplanes(); p ++) {
@@ -51,19 +68,34 @@ bool DrawShower::analyze(gallery::Event * ev) {
     _wireRange.at(p).second = -1.0;
   }
 
+  if (showerHandle->size() == 0) {
+    GALLERY_FMWK_MSG(galleryfmwk::msg::kINFO, __FUNCTION__,
+                     Form("No showers available to draw by producer %s", _producer.c_str()));
+    return true;
+  }
+
+  // The slope of every shower in every plane, at once:
+  _directions.clear();
+  _directions.reserve(showerHandle->size());
+  for (auto const& shower : *showerHandle)
+    _directions.push_back(shower.Direction().X(), shower.Direction().Y(), shower.Direction().Z());
+
+  std::vector<std::vector<float> > slopes_by_plane(_geoService.Nplanes());
+  for (unsigned int view = 0; view < _geoService.Nplanes(); view++)
+    Slopes_3Dto2D(_directions, view, slopes_by_plane[view]);
+
   // Populate the shower vector:
   for (size_t s = 0; s < showerHandle->size(); s++) 
   {
     auto const& shower = showerHandle->at(s);
 
-    std::vector<recob::Hit const*> hits;
-    hits_for_shower.get(s, hits);
-    std::cout << "There are " << hits.size() << " associated with this shower" << std::endl;
+    auto const hits = hits_for_shower.at(s);
+    GALLERY_FMWK_DEBUG(__FUNCTION__, Form("There are %zu hits associated with this shower", hits.size()));
 
     for (unsigned int view = 0; view < _geoService.Nplanes(); view++) 
     {
       // get the reconstructed shower for this plane
-      auto shr2D = getShower2d(shower, view);
+      auto shr2D = getShower2d(shower, view, slopes_by_plane[view][s]);
 
       shr2D._showerCluster_v.resize(3);
 
@@ -76,18 +108,8 @@ bool DrawShower::analyze(gallery::Event * ev) {
       {
 	
 	       if (hit->WireID().Plane != view) continue;
-	
-	Hit2D hit2d(hit->WireID().Wire,
-		  hit->PeakTime(),
-		  hit->Integral(),
-		  hit->RMS(),
-		  hit->StartTick(),
-		  hit->PeakTime(),
-		  hit->EndTick(),
-		  hit->PeakAmplitude(),
-		  view);
-
-	clus.push_back(hit2d);
+
+	clus.push_back(hit_store.index(hit));
 	
       }// for all hits
 
@@ -112,6 +134,12 @@ bool DrawShower::finalize() {
 
 
 Shower2D DrawShower::getShower2d(recob::Shower shower, unsigned int plane) 
+{
+  const TVector3& showerDir = shower.Direction();
+  return getShower2d(shower, plane, Slope_3Dto2D(showerDir.X(), showerDir.Y(), showerDir.Z(), plane));
+}
+
+Shower2D DrawShower::getShower2d(const recob::Shower & shower, unsigned int plane, float angleInPlane) 
 {
   Shower2D result;
   result._is_good = false;
@@ -122,9 +150,7 @@ Shower2D DrawShower::getShower2d(recob::Shower shower, unsigned int plane)
   result._startPoint = Point_3Dto2D(showerStart.X(), showerStart.Y(), showerStart.Z(), plane);
 
   // Next get the direction:
-  const TVector3& showerDir = shower.Direction();
-
-  result._angleInPlane = Slope_3Dto2D(showerDir.X(), showerDir.Y(), showerDir.Z(), plane);
+  result._angleInPlane = angleInPlane;
 
   // Get the opening Angle:
   // result._openingAngle = shower.OpeningAngle();
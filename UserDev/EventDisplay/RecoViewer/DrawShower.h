@@ -53,6 +53,9 @@ namespace evd {
     float dedx() {return _dedx;}
     float energy() { return _energy; }
 
+    /// Box around the cone drawn for the shower, in cm
+    Box2D boundingBox() const;
+
     // ALL OF THESE VARIABLES ARE THE PROJECTION INTO THE PLANE
     int _plane;               ///< The Plane of the shower
     evd::Point2D _startPoint; ///< Wire time start point (units in cm)
@@ -111,6 +114,14 @@ public:
 
     Shower2D getShower2d(recob::Shower shower, unsigned int plane);
 
+private:
+
+    /// getShower2d with the slope in the plane already known
+    Shower2D getShower2d(const recob::Shower & shower, unsigned int plane, float angleInPlane);
+
+    // Directions of the showers of the event, for Slopes_3Dto2D
+    Points3D _directions;
+
 };
 
 } // evd
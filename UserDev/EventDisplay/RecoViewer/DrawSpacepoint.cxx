@@ -21,12 +21,25 @@ bool DrawSpacepoint::initialize()
     return true;
 }
 
+std::vector<std::string> DrawSpacepoint::resources() const
+{
+    return std::vector<std::string>(1, "recob::SpacePoint:" + _producer);
+}
+
+bool DrawSpacepoint::prefetch(gallery::Event * ev)
+{
+    ev->getValidHandle<std::vector <recob::SpacePoint> >(art::InputTag(_producer));
+    return true;
+}
+
 bool DrawSpacepoint::analyze(gallery::Event * ev) 
 {
     // get a handle to the tracks
     art::InputTag sps_tag(_producer);
     auto const & spacepointHandle = ev -> getValidHandle<std::vector <recob::SpacePoint> >(sps_tag);
   
+    _invalidateWindowIndex();
+
     // Clear out the data but reserve some space
     for (unsigned int p = 0; p < _geoService.Nplanes(); p ++) 
     {
@@ -50,6 +50,11 @@ public:
     */
     virtual bool analyze(gallery::Event * event);
 
+    /// Reads one product, see anabase::resources
+    virtual std::vector<std::string> resources() const;
+
+    virtual bool prefetch(gallery::Event * event);
+
     /** IMPLEMENT in DrawCluster.cc!
         Finalize method to be called after all events processed.
     */
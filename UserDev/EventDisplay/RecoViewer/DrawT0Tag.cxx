@@ -2,24 +2,27 @@
 #define EVD_DRAWT0TAG_CXX
 
 #include "DrawT0Tag.h"
+#include "Base/messenger.h"
 
 namespace evd {
 
-T0Tag DrawT0Tag::getTrack2D(recob::Track track, unsigned int plane) {
+T0Tag DrawT0Tag::getTrack2D(const recob::Track & track, unsigned int plane) {
     T0Tag result;
-    result._track.reserve(track.NumberTrajectoryPoints());
+
+    // Collect the valid points, then project them all at once:
+    Points3D points;
+    points.reserve(track.NumberTrajectoryPoints());
     for (unsigned int i = 0; i < track.NumberTrajectoryPoints(); i++) {
-      // project a point into 2D:
       try {
 	if (track.HasValidPoint(i)) {
 	  auto loc = track.LocationAtPoint(i);
-	  auto point = Point_3Dto2D(loc.X(), loc.Y(), loc.Z(), plane);
-	  result._track.push_back(std::make_pair(point.w, point.t));
+	  points.push_back(loc.X(), loc.Y(), loc.Z());
 	}
       } catch (...) {
 	continue;
       }
     }
+    Points_3Dto2D(points, plane, result._track);
     
     return result;
   }
@@ -42,7 +45,7 @@ bool DrawT0Tag::initialize() {
 
 bool DrawT0Tag::analyze(gallery::Event *ev) 
 {
-  std::cout << "ENTERED T0 DRAW CLASS" << std::endl;
+  GALLERY_FMWK_DEBUG(__FUNCTION__, "ENTERED T0 DRAW CLASS");
 
   std::vector<anab::T0>     t0tags; 
   std::vector<recob::Track> tracks;
@@ -66,6 +69,8 @@ bool DrawT0Tag::analyze(gallery::Event *ev)
 
   }
 
+  _invalidateWindowIndex();
+
   // Clear out the data but reserve some space for the tracks
   for (unsigned int p = 0; p < _geoService.Nplanes(); p++) 
   {
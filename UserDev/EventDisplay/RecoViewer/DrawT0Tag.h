@@ -64,7 +64,7 @@ public:
   virtual bool finalize();
 
 private:
-  T0Tag getTrack2D(recob::Track track, unsigned int plane);
+  T0Tag getTrack2D(const recob::Track & track, unsigned int plane);
 };
 
 } // evd
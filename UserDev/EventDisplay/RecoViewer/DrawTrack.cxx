@@ -5,25 +5,110 @@
 
 namespace evd {
 
-Track2D DrawTrack::getTrack2D(recob::Track track, unsigned int plane) 
+std::vector<std::pair<float, float>> Track2D::track(float tolerance) const
+{
+  if (_detail.size() != _track.size())
+    return _track;
+
+  std::vector<std::pair<float, float>> result;
+  for (size_t i = 0; i < _track.size(); i++)
+  {
+    if (_detail[i] > tolerance)
+      result.push_back(_track[i]);
+  }
+  return result;
+}
+
+void Track2D::computeLevelOfDetail()
+{
+  size_t n = _track.size();
+  _detail.assign(n, 0.0);
+  if (n == 0)
+    return;
+
+  // The end points are always kept
+  _detail.front() = std::numeric_limits<float>::max();
+  _detail.back() = std::numeric_limits<float>::max();
+
+  // Segments still to split: first point, last point, detail of the point that made them.
+  // A point is never more detailed than its parent, so the points kept at a tolerance
+  // are exactly the ones Douglas-Peucker keeps at that tolerance.
+  struct Segment {
+    size_t first;
+    size_t last;
+    float limit;
+  };
+  std::vector<Segment> stack;
+  stack.push_back({0, n - 1, std::numeric_limits<float>::max()});
+
+  while (!stack.empty())
+  {
+    Segment seg = stack.back();
+    stack.pop_back();
+    if (seg.last <= seg.first + 1)
+      continue;
+
+    // Farthest point from the segment first-last
+    float w0 = _track[seg.first].first;
+    float t0 = _track[seg.first].second;
+    float dw = _track[seg.last].first - w0;
+    float dt = _track[seg.last].second - t0;
+    float length2 = dw * dw + dt * dt;
+
+    size_t farthest = seg.first + 1;
+    float max_dist2 = -1;
+    for (size_t i = seg.first + 1; i < seg.last; i++)
+    {
+      float pw = _track[i].first - w0;
+      float pt = _track[i].second - t0;
+      float s = (length2 > 0) ? (pw * dw + pt * dt) / length2 : 0;
+      s = std::min(std::max(s, 0.0f), 1.0f);
+      float ew = pw - s * dw;
+      float et = pt - s * dt;
+      float dist2 = ew * ew + et * et;
+      if (dist2 > max_dist2)
+      {
+        max_dist2 = dist2;
+        farthest = i;
+      }
+    }
+
+    float detail = std::min(std::sqrt(max_dist2), seg.limit);
+    _detail[farthest] = detail;
+    stack.push_back({seg.first, farthest, detail});
+    stack.push_back({farthest, seg.last, detail});
+  }
+}
+
+Box2D Track2D::boundingBox() const
+{
+  Box2D box;
+  for (auto const & point : _track)
+    box.extend(point.first, point.second);
+  return box;
+}
+
+Track2D DrawTrack::getTrack2D(const recob::Track & track, unsigned int plane) 
 {
   Track2D result;
-  result._track.reserve(track.NumberTrajectoryPoints());
-  
+
+  // Collect the valid points, then project them all at once:
+  Points3D points;
+  points.reserve(track.NumberTrajectoryPoints());
   for (unsigned int i = 0; i < track.NumberTrajectoryPoints(); i++) 
   {
-    // project a point into 2D:
     try {
       if (track.HasValidPoint(i)) 
       {
 	       auto loc = track.LocationAtPoint(i);
-         auto point = Point_3Dto2D(loc.X(),loc.Y(),loc.Z(), plane);
-         result._track.push_back(std::make_pair(point.w, point.t));
+         points.push_back(loc.X(), loc.Y(), loc.Z());
       }
     } catch (...) {
       continue;
     }
   }
+  Points_3Dto2D(points, plane, result._track);
+  result.computeLevelOfDetail();
 
   return result;
 }
@@ -44,6 +129,17 @@ bool DrawTrack::initialize() {
   return true;
 }
 
+std::vector<std::string> DrawTrack::resources() const
+{
+  return std::vector<std::string>(1, "recob::Track:" + _producer);
+}
+
+bool DrawTrack::prefetch(gallery::Event * ev)
+{
+  ev->getValidHandle<std::vector<recob::Track> >(art::InputTag(_producer));
+  return true;
+}
+
 bool DrawTrack::analyze(gallery::Event *ev) 
 {
   //
@@ -67,6 +163,8 @@ bool DrawTrack::analyze(gallery::Event *ev)
   art::InputTag tracks_tag(_producer);
   auto const &trackHandle = ev->getValidHandle<std::vector<recob::Track>>(tracks_tag);
 
+  _invalidateWindowIndex();
+
   // Clear out the data but reserve some space for the tracks
   for (unsigned int p = 0; p < _geoService.Nplanes(); p++) 
   {
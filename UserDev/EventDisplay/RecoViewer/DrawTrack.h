@@ -16,7 +16,12 @@
 
 #include "Analysis/anabase.h"
 #include "lardataobj/RecoBase/Track.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <utility>
+#include <vector>
 
 #include "RecoBase.h"
 
@@ -43,8 +48,32 @@ public:
   const std::vector<std::pair<float, float>> &track() { return _track; }
   const std::vector<std::pair<float, float>> &direction() { return _track; }
 
+  /**
+   * @brief The track simplified to a tolerance, for drawing zoomed out
+   * @details Douglas-Peucker: the points kept are the ones further than tolerance
+   *          from the simplified line around them.  Needs computeLevelOfDetail,
+   *          without it the full track is returned.
+   *
+   * @param tolerance Largest distance (cm) of a dropped point to the returned line
+   */
+  std::vector<std::pair<float, float>> track(float tolerance) const;
+
+  /**
+   * @brief Rank the points of the track for track(tolerance)
+   * @details Runs Douglas-Peucker once over the whole track and stores, for each
+   *          point, the largest tolerance at which it is still kept.  Any level of
+   *          detail is then one pass over the points.
+   */
+  void computeLevelOfDetail();
+
+  /// Box around all the points of the track, in cm
+  Box2D boundingBox() const;
+
 protected:
   std::vector<std::pair<float, float>> _track;
+
+  // Largest tolerance (cm) at which each point of _track is kept, empty if not computed
+  std::vector<float> _detail;
 };
 
 // typedef std::vector<std::pair<float, float> > Track2D;
@@ -62,10 +91,15 @@ public:
 
   virtual bool analyze(gallery::Event *event);
 
+  /// Reads one product, see anabase::resources
+  virtual std::vector<std::string> resources() const;
+
+  virtual bool prefetch(gallery::Event * event);
+
   virtual bool finalize();
 
 private:
-  Track2D getTrack2D(recob::Track track, unsigned int plane);
+  Track2D getTrack2D(const recob::Track & track, unsigned int plane);
 };
 
 } // evd
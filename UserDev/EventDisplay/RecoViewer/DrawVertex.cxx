@@ -27,11 +27,24 @@ bool DrawVertex::initialize()
 
 }
 
+std::vector<std::string> DrawVertex::resources() const
+{
+  return std::vector<std::string>(1, "recob::Vertex:" + _producer);
+}
+
+bool DrawVertex::prefetch(gallery::Event * ev)
+{
+  ev->getValidHandle<std::vector <recob::Vertex> >(art::InputTag(_producer));
+  return true;
+}
+
 bool DrawVertex::analyze(gallery::Event * ev) 
 {
   art::InputTag vertex_tag(_producer);
   auto const & vertexHandle = ev -> getValidHandle<std::vector <recob::Vertex> >(vertex_tag);
 
+  _invalidateWindowIndex();
+
   // Clear out the hit data but reserve some space for the hits
   for (unsigned int plane = 0; plane < _geoService.Nplanes(); plane ++) 
   {
@@ -43,6 +43,11 @@ public:
 
   virtual bool analyze(gallery::Event * event);
 
+  /// Reads one product, see anabase::resources
+  virtual std::vector<std::string> resources() const;
+
+  virtual bool prefetch(gallery::Event * event);
+
   virtual bool finalize();
 
 
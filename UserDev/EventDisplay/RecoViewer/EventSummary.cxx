@@ -0,0 +1,209 @@
+#ifndef EVD_EVENTSUMMARY_CXX
+#define EVD_EVENTSUMMARY_CXX
+
+#include "EventSummary.h"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <tuple>
+
+#include "canvas/Utilities/InputTag.h"
+#include "gallery/Event.h"
+#include "lardataobj/RecoBase/Hit.h"
+#include "lardataobj/RecoBase/Shower.h"
+#include "lardataobj/RecoBase/Track.h"
+#include "lardataobj/RecoBase/Wire.h"
+
+#include "TDirectory.h"
+#include "TTree.h"
+
+namespace evd {
+
+namespace {
+
+template <class T> void append(std::vector<T> & to, const std::vector<T> & from)
+{
+  to.insert(to.end(), from.begin(), from.end());
+}
+
+}
+
+EventSummary::EventSummary(const geo::GeometryCore& geometry) :
+  _geoService(geometry)
+{
+  _name = "EventSummary";
+  _fout = 0;
+}
+
+bool EventSummary::initialize()
+{
+  _run.clear();
+  _subrun.clear();
+  _event.clear();
+  _n_tracks.clear();
+  _n_showers.clear();
+  _charge.assign(_geoService.Nplanes(), std::vector<float>());
+  _occupancy.assign(_geoService.Nplanes(), std::vector<float>());
+  _n_hits.assign(_geoService.Nplanes(), std::vector<unsigned int>());
+  return true;
+}
+
+std::vector<std::string> EventSummary::resources() const
+{
+  std::vector<std::string> result;
+  if (!_wire_producer.empty()) result.push_back("recob::Wire:" + _wire_producer);
+  if (!_hit_producer.empty()) result.push_back("recob::Hit:" + _hit_producer);
+  if (!_track_producer.empty()) result.push_back("recob::Track:" + _track_producer);
+  if (!_shower_producer.empty()) result.push_back("recob::Shower:" + _shower_producer);
+  return result;
+}
+
+bool EventSummary::prefetch(gallery::Event * ev)
+{
+  if (!_wire_producer.empty())
+    ev->getValidHandle<std::vector<recob::Wire> >(art::InputTag(_wire_producer));
+  if (!_hit_producer.empty())
+    ev->getValidHandle<std::vector<recob::Hit> >(art::InputTag(_hit_producer));
+  if (!_track_producer.empty())
+    ev->getValidHandle<std::vector<recob::Track> >(art::InputTag(_track_producer));
+  if (!_shower_producer.empty())
+    ev->getValidHandle<std::vector<recob::Shower> >(art::InputTag(_shower_producer));
+  return true;
+}
+
+bool EventSummary::analyze(gallery::Event * ev)
+{
+  size_t n_planes = _geoService.Nplanes();
+
+  auto const & aux = ev->eventAuxiliary();
+  _run.push_back(aux.run());
+  _subrun.push_back(aux.subRun());
+  _event.push_back(aux.event());
+
+  std::vector<double> charge(n_planes, 0);
+  std::vector<double> roi_samples(n_planes, 0);
+  std::vector<double> samples(n_planes, 0);
+  std::vector<unsigned int> n_hits(n_planes, 0);
+
+  if (!_wire_producer.empty()) {
+    auto const & wires = ev->getValidHandle<std::vector<recob::Wire> >(art::InputTag(_wire_producer));
+    for (auto const & wire : *wires) {
+      std::vector<geo::WireID> wire_ids = _geoService.ChannelToWire(wire.Channel());
+      if (wire_ids.empty() || wire_ids[0].Plane >= n_planes) continue;
+      size_t plane = wire_ids[0].Plane;
+      samples[plane] += wire.NSignal();
+      for (auto const & roi : wire.SignalROI().get_ranges()) {
+        roi_samples[plane] += roi.size();
+        charge[plane] += std::accumulate(roi.begin(), roi.end(), 0.0);
+      }
+    }
+  }
+
+  if (!_hit_producer.empty()) {
+    auto const & hits = ev->getValidHandle<std::vector<recob::Hit> >(art::InputTag(_hit_producer));
+    for (auto const & hit : *hits)
+      if (hit.WireID().Plane < n_planes) n_hits[hit.WireID().Plane]++;
+  }
+
+  _n_tracks.push_back(_track_producer.empty() ? 0 :
+                      ev->getValidHandle<std::vector<recob::Track> >(art::InputTag(_track_producer))->size());
+  _n_showers.push_back(_shower_producer.empty() ? 0 :
+                       ev->getValidHandle<std::vector<recob::Shower> >(art::InputTag(_shower_producer))->size());
+
+  for (size_t p = 0; p < n_planes; p++) {
+    _charge[p].push_back(charge[p]);
+    _occupancy[p].push_back(samples[p] > 0 ? roi_samples[p] / samples[p] : 0);
+    _n_hits[p].push_back(n_hits[p]);
+  }
+
+  return true;
+}
+
+galleryfmwk::anabase* EventSummary::clone() const
+{
+  EventSummary * result = new EventSummary(_geoService);
+  result->_wire_producer = _wire_producer;
+  result->_hit_producer = _hit_producer;
+  result->_track_producer = _track_producer;
+  result->_shower_producer = _shower_producer;
+  return result;
+}
+
+bool EventSummary::merge(const galleryfmwk::anabase& worker)
+{
+  const EventSummary & other = dynamic_cast<const EventSummary &>(worker);
+
+  append(_run, other._run);
+  append(_subrun, other._subrun);
+  append(_event, other._event);
+  append(_n_tracks, other._n_tracks);
+  append(_n_showers, other._n_showers);
+  for (size_t p = 0; p < _charge.size(); p++) {
+    append(_charge[p], other._charge[p]);
+    append(_occupancy[p], other._occupancy[p]);
+    append(_n_hits[p], other._n_hits[p]);
+  }
+  return true;
+}
+
+bool EventSummary::finalize()
+{
+  if (_fout) write(_fout);
+  return true;
+}
+
+void EventSummary::write(TDirectory* dir) const
+{
+  // The workers of a parallel run finish in any order
+  std::vector<size_t> order(size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    return std::tie(_run[a], _subrun[a], _event[a]) < std::tie(_run[b], _subrun[b], _event[b]);
+  });
+
+  TDirectory * previous = gDirectory;
+  dir->cd();
+
+  TTree * tree = new TTree("eventsummary", "Event summary for triage");
+
+  unsigned int run, subrun, event, n_tracks, n_showers;
+  size_t n_planes = _charge.size();
+  std::vector<float> charge(n_planes), occupancy(n_planes);
+  std::vector<unsigned int> n_hits(n_planes);
+
+  tree->Branch("run", &run, "run/i");
+  tree->Branch("subrun", &subrun, "subrun/i");
+  tree->Branch("event", &event, "event/i");
+  tree->Branch("n_tracks", &n_tracks, "n_tracks/i");
+  tree->Branch("n_showers", &n_showers, "n_showers/i");
+  for (size_t p = 0; p < n_planes; p++) {
+    std::string plane = "_" + std::to_string(p);
+    tree->Branch(("charge" + plane).c_str(), &charge[p], ("charge" + plane + "/F").c_str());
+    tree->Branch(("occupancy" + plane).c_str(), &occupancy[p], ("occupancy" + plane + "/F").c_str());
+    tree->Branch(("n_hits" + plane).c_str(), &n_hits[p], ("n_hits" + plane + "/i").c_str());
+  }
+
+  for (size_t i : order) {
+    run = _run[i];
+    subrun = _subrun[i];
+    event = _event[i];
+    n_tracks = _n_tracks[i];
+    n_showers = _n_showers[i];
+    for (size_t p = 0; p < n_planes; p++) {
+      charge[p] = _charge[p][i];
+      occupancy[p] = _occupancy[p][i];
+      n_hits[p] = _n_hits[p][i];
+    }
+    tree->Fill();
+  }
+
+  tree->Write();
+  delete tree;
+
+  if (previous) previous->cd();
+}
+
+} // evd
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * \file EventSummary.h
+ *
+ * \ingroup RecoViewer
+ *
+ * \brief Class def header for a class EventSummary
+ *
+ * Per event numbers to triage a file before drawing it: charge and ROI
+ * occupancy of the wires, hits, tracks and showers.
+ *
+ * @author cadams
+ */
+
+/** \addtogroup RecoViewer
+
+    @{*/
+#ifndef EVD_EVENTSUMMARY_H
+#define EVD_EVENTSUMMARY_H
+
+#include <string>
+#include <vector>
+
+#include "Analysis/anabase.h"
+#include "larcorealg/Geometry/GeometryCore.h"
+
+class TDirectory;
+
+namespace evd {
+
+/**
+   \class EventSummary
+   One row per event, written as the TTree "eventsummary" to the analysis
+   output file of the anaprocessor, sorted by (run, subrun, event).  The
+   branches are all scalars:
+     run, subrun, event, n_tracks, n_showers
+     charge_<p>     sum of the ROI samples of the wires of plane p
+     occupancy_<p>  fraction of the samples of the wires of plane p in an ROI
+     n_hits_<p>     hits on plane p
+   Only the products of the producers that are set are read, the columns of
+   the others are 0.  The module can be cloned, so it runs in a parallel
+   anaprocessor run.
+ */
+class EventSummary : public galleryfmwk::anabase {
+
+public:
+
+  /// Default constructor
+  EventSummary(const geo::GeometryCore& geometry);
+
+  /// Default destructor
+  virtual ~EventSummary() {}
+
+  void setWireProducer(const std::string& s) {_wire_producer = s;}
+  void setHitProducer(const std::string& s) {_hit_producer = s;}
+  void setTrackProducer(const std::string& s) {_track_producer = s;}
+  void setShowerProducer(const std::string& s) {_shower_producer = s;}
+
+  virtual bool initialize();
+
+  virtual bool analyze(gallery::Event* event);
+
+  /// Writes the tree to the output file if there is one
+  virtual bool finalize();
+
+  virtual galleryfmwk::anabase* clone() const;
+
+  virtual bool merge(const galleryfmwk::anabase& worker);
+
+  virtual std::vector<std::string> resources() const;
+
+  virtual bool prefetch(gallery::Event* event);
+
+  /// Number of events summarized
+  size_t size() const {return _run.size();}
+
+  /// Write the rows as the tree "eventsummary" in dir
+  void write(TDirectory* dir) const;
+
+private:
+
+  const geo::GeometryCore& _geoService;
+
+  std::string _wire_producer;
+  std::string _hit_producer;
+  std::string _track_producer;
+  std::string _shower_producer;
+
+  // One entry per event in the order they were analyzed, per plane columns are [plane][row]
+  std::vector<unsigned int> _run;
+  std::vector<unsigned int> _subrun;
+  std::vector<unsigned int> _event;
+  std::vector<unsigned int> _n_tracks;
+  std::vector<unsigned int> _n_showers;
+  std::vector<std::vector<float> > _charge;
+  std::vector<std::vector<float> > _occupancy;
+  std::vector<std::vector<unsigned int> > _n_hits;
+
+};
+
+} // evd
+
+#endif
+/** @} */ // end of doxygen group
@@ -0,0 +1,76 @@
+#ifndef EVD_HITSTORE_CXX
+#define EVD_HITSTORE_CXX
+
+#include "HitStore.h"
+
+namespace evd {
+
+HitStore::HitStore() :
+  _event(nullptr),
+  _file_entry(-1),
+  _event_entry(-1),
+  _has_event(false)
+{}
+
+HitStore & HitStore::GetME()
+{
+  static HitStore store;
+  return store;
+}
+
+void HitStore::set_event(gallery::Event * ev)
+{
+  art::EventID id = ev->eventAuxiliary().id();
+  if (_has_event && ev == _event &&
+      ev->fileEntry() == _file_entry &&
+      ev->eventEntry() == _event_entry &&
+      id == _event_id)
+    return;
+
+  _event = ev;
+  _file_entry = ev->fileEntry();
+  _event_entry = ev->eventEntry();
+  _event_id = id;
+  _has_event = true;
+  _hits.clear();
+  _index_by_product.clear();
+}
+
+size_t HitStore::index(const art::Ptr<recob::Hit> & hit)
+{
+  std::vector<long> & indices = _index_by_product[hit.id()];
+  if (indices.size() <= hit.key())
+    indices.resize(hit.key() + 1, -1);
+
+  long & index = indices[hit.key()];
+  if (index < 0)
+  {
+    index = _hits.size();
+    _hits.emplace_back(
+      Hit2D(hit->WireID().Wire,
+            hit->PeakTime(),
+            hit->Integral(),
+            hit->RMS(),
+            hit->StartTick(),
+            hit->PeakTime(),
+            hit->EndTick(),
+            hit->PeakAmplitude(),
+            hit->WireID().Plane
+           ));
+  }
+
+  return index;
+}
+
+Box2D HitIndexList::boundingBox() const
+{
+  Box2D box;
+  const HitStore & store = HitStore::GetME();
+  for (auto index : _hit_indices)
+    box.extend(store.hit(index).boundingBox());
+  return box;
+}
+
+} // evd
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * \file HitStore.h
+ *
+ * \ingroup RecoViewer
+ *
+ * \brief Class def header for a class HitStore
+ *
+ * Per event table of Hit2D shared by the drawers that show associated hits
+ * (clusters, showers, slices).  Each recob::Hit is converted once, the
+ * drawers keep lists of indices into the table.
+ *
+ * @author cadams
+ */
+
+/** \addtogroup RecoViewer
+
+    @{*/
+#ifndef EVD_HITSTORE_H
+#define EVD_HITSTORE_H
+
+#include <map>
+#include <vector>
+
+#include "gallery/Event.h"
+#include "canvas/Persistency/Common/Ptr.h"
+#include "lardataobj/RecoBase/Hit.h"
+
+#include "DrawHit.h"
+
+namespace evd {
+
+/**
+   \class HitStore
+   Hits of the current event, keyed by the art::Ptr they come from.
+ */
+class HitStore {
+
+public:
+
+  /// The store shared by all the drawers
+  static HitStore & GetME();
+
+  /**
+   * @brief Start using the store for this event
+   * @details The table is cleared when the event is not the one seen last,
+   *          so every drawer calls this at the start of analyze and the
+   *          first one on a new event resets it.  The event is recognized
+   *          by the gallery::Event, its file and entry, and its ID: event
+   *          IDs repeat across (MC) files and the display replaces the
+   *          gallery::Event when it jumps to another file.
+   */
+  void set_event(gallery::Event * ev);
+
+  /**
+   * @brief Index of this hit in the table, converting it if it is new
+   *
+   * @param hit Pointer to the hit, as returned by art::FindManyP
+   * @return Index to use with hit()
+   */
+  size_t index(const art::Ptr<recob::Hit> & hit);
+
+  /// Hit at this index, throws if the index is not in the table
+  const Hit2D & hit(size_t index) const {return _hits.at(index);}
+
+  /// Number of hits in the table
+  size_t size() const {return _hits.size();}
+
+private:
+
+  HitStore();
+
+  // The event seen last
+  const gallery::Event * _event;
+  long long _file_entry;
+  long long _event_entry;
+  art::EventID _event_id;
+  bool _has_event;
+
+  // Hits of the event, in the order they were first requested
+  std::vector<Hit2D> _hits;
+
+  // For each hit product, the table index of each Ptr key (-1 if not yet seen)
+  std::map<art::ProductID, std::vector<long> > _index_by_product;
+
+};
+
+/**
+   \class HitIndexList
+   List of hits given by their index in the HitStore.  It looks like a
+   vector of Hit2D to python: len() and [] return the hits themselves.
+ */
+class HitIndexList {
+
+public:
+
+  HitIndexList() {}
+
+  size_t size() const {return _hit_indices.size();}
+  const Hit2D & operator[](size_t i) const {return HitStore::GetME().hit(_hit_indices.at(i));}
+
+  void push_back(size_t index) {_hit_indices.push_back(index);}
+  void reserve(size_t n) {_hit_indices.reserve(n);}
+  void clear() {_hit_indices.clear();}
+
+  const std::vector<size_t> & hit_indices() const {return _hit_indices;}
+
+  /// Union of the boxes of the hits, in wire and tick
+  Box2D boundingBox() const;
+
+protected:
+
+  std::vector<size_t> _hit_indices;
+
+};
+
+} // evd
+
+#endif
+/** @} */ // end of doxygen group
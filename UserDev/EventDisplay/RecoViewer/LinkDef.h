@@ -23,6 +23,9 @@
 #pragma link C++ class evd::RecoBase<evd::Hit2D>+;
 #pragma link C++ class evd::DrawHit+;
 
+#pragma link C++ class evd::HitIndexList+;
+#pragma link C++ class std::vector<::evd::HitIndexList>+;
+
 #pragma link C++ class evd::Cluster2D+;
 #pragma link C++ class std::vector<::evd::Cluster2D>+;
 #pragma link C++ class evd::RecoBase<evd::Cluster2D>+;
@@ -55,6 +58,7 @@
 // Link the classes that are processors
 #pragma link C++ class evd::DrawVertex+;
 #pragma link C++ class evd::DrawSpacepoint+;
+#pragma link C++ class evd::EventSummary+;
 
 //#pragma link C++ class evd::Neutrino2D+;
 //#pragma link C++ class std::vector<::evd::Neutrino2D>+;
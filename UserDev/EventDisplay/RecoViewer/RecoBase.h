@@ -17,7 +17,13 @@
 #include "larcorealg/Geometry/GeometryCore.h"
 #include "lardataalg/DetectorInfo/DetectorProperties.h"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "WindowIndex.h"
 
 struct _object;
 typedef _object PyObject;
@@ -59,6 +65,8 @@ public:
       w     = 0;
       t     = 0;
     }
+
+    Box2D boundingBox() const {return Box2D(w, w, t, t);}
   
     ~PxPoint() {}
 };
@@ -66,6 +74,20 @@ public:
 /// This is gonna be really really useful. Trust me. 
 using Point2D = PxPoint;
 
+/// Points in 3D stored as one array per coordinate, for RecoBase::Points_3Dto2D
+class Points3D
+{
+public:
+    void clear() {x.clear(); y.clear(); z.clear();}
+    void reserve(size_t n) {x.reserve(n); y.reserve(n); z.reserve(n);}
+    void push_back(float xx, float yy, float zz) {x.push_back(xx); y.push_back(yy); z.push_back(zz);}
+    size_t size() const {return x.size();}
+
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+};
+
 template <class DATA_TYPE> class RecoBase 
 {
 public:
@@ -83,6 +105,23 @@ public:
   
     const std::vector<DATA_TYPE> & getDataByPlane(size_t p);
 
+    /**
+     * @brief Indices in getDataByPlane(p) of the objects that overlap a window
+     * @details The window is in the units of the data: wire and tick for hits, clusters
+     *          and end points, cm for tracks, showers, vertices and space points.  Objects
+     *          are matched by their boundingBox().  The bounding boxes of a plane are put
+     *          in a uniform grid (WindowIndex) the first time the plane is asked for after
+     *          analyze, later windows only look at the grid cells they cover.
+     *
+     * @return The indices in increasing order, so colors by index do not change with the window
+     */
+    std::vector<size_t> getIndicesInWindow(size_t p, float wmin, float wmax, float tmin, float tmax);
+
+    /**
+     * @brief Copies of the objects of plane p that overlap a window, see getIndicesInWindow
+     */
+    std::vector<DATA_TYPE> getDataInWindow(size_t p, float wmin, float wmax, float tmin, float tmax);
+
     // PyObject * getDataByPlane(size_t p);
 
     /**
@@ -97,13 +136,59 @@ public:
      */
     Point2D Point_3Dto2D(float x, float y, float z, unsigned int plane) const;
 
+    /**
+     * @brief Project n points in 3D to a plane at once
+     * @details Same projection as Point_3Dto2D.  The wire coordinate is an
+     *          affine function of (y, z), its coefficients for each plane
+     *          are taken from the geometry once, in the constructor, so this
+     *          is a single multiply-add loop with no geometry calls.
+     *
+     * @param x, y, z Arrays of the n point coordinates, in cm
+     * @param n Number of points
+     * @param plane The index of the plane to project into
+     * @param w Returned: wire coordinate of each point, in cm
+     * @param t Returned: time coordinate of each point, in cm
+     */
+    void Points_3Dto2D(const float * x, const float * y, const float * z, size_t n,
+                       unsigned int plane, float * w, float * t) const;
+
+    /**
+     * @brief Project points to a plane, appending (wire, time) pairs in cm to result
+     */
+    void Points_3Dto2D(const Points3D & points, unsigned int plane,
+                       std::vector<std::pair<float, float> > & result) const;
+
+    /**
+     * @brief Slope (time over wire) in a plane of a 3D direction
+     * @details The direction is taken through the middle of the detector, see Line_3Dto2D
+     */
+     float Slope_3Dto2D(float x, float y, float z, unsigned int plane) const ;    
+
+    /**
+     * @brief Slope_3Dto2D of n directions at once, for example every shower of an event
+     *
+     * @param directions The 3D directions, need not be normalized
+     * @param plane The plane in which the projection needs to be done
+     * @param slopes Returned: the slope of each direction
+     */
+    void Slopes_3Dto2D(const Points3D & directions, unsigned int plane, std::vector<float> & slopes) const;
+
+protected:
+
+    void _init_base();
+
+    /// Drop the window index, call when _dataByPlane is refilled
+    void _invalidateWindowIndex();
+
     /**
      * @brief Take a line (start point and direction) and project that into 2D
      * @details This function will return the start point and direction of a line segment projected into 2D
-     *  It works by using the Point_3Dto2D function to project the start point into 2D.  Then, it finds a second
-     *  point along the line by using startPoint + direction3D.  If that point is not in the TPC, it halves the distance and
-     *  tries that point.  Then, once it has two points in the TPC, it projects both into the plane, normalizes the direction,
-     *  and returns them as PxPoints by reference
+     *  It works by using the Point_3Dto2D function to project the start point into 2D.  Then, it takes a second
+     *  point on the line inside the TPC: the line is clipped against the TPC box (Line_clipToTPC) and the point
+     *  is 10 direction lengths from the start, or the nearest point of the clipped segment.  If the line misses the
+     *  TPC, the point 10 direction lengths away is used as is.  Both points are projected into the plane, the
+     *  direction is normalized, and they are returned as PxPoints by reference.  There is no search, the cost
+     *  is the same for every line.
      *
      * @param startPoint3D TVector3 describing the 3D start point (in detector coordinates)
      * @param direction3D TVector3 describing the direction that the line emanates from the start point.  Need not be normalized
@@ -111,15 +196,21 @@ public:
      * @param startPoint2D Returned by reference: A Point2D representing the projection of the start point into the plane.
      * @param direction2D Returned by reference: A Point2D representing the projection of the direction into the plane, normalized.
      */
-     float Slope_3Dto2D(float x, float y, float z, unsigned int plane) const ;    
-
-protected:
-
-    void _init_base();
-
     void Line_3Dto2D( const TVector3 & startPoint3D, const TVector3 & direction3D, unsigned int plane,
                       Point2D& startPoint2D, Point2D& direction2D) const;
 
+    /**
+     * @brief Clip a line against the TPC box
+     * @details Slab method: the line is startPoint3D + s * direction3D, the range of s inside
+     *          the box is the overlap of the ranges between each pair of faces.
+     *
+     * @param s_min Returned: smallest s inside the TPC
+     * @param s_max Returned: largest s inside the TPC
+     * @return false if the line does not cross the TPC
+     */
+    bool Line_clipToTPC(const TVector3 & startPoint3D, const TVector3 & direction3D,
+                        double & s_min, double & s_max) const;
+
     /**
      * @brief deterimine if a point is in the TPC
      * @details Checks this point against the geometry parameters
@@ -132,10 +223,29 @@ protected:
     const geo::GeometryCore&           _geoService;
     const detinfo::DetectorProperties& _detProp;
 
+    // Wire coordinate (cm) on each plane is wire_y * y + wire_z * z + wire_offset
+    struct PlaneProjection {
+        float wire_y;
+        float wire_z;
+        float wire_offset;
+    };
+    std::vector<PlaneProjection> _projectionByPlane;
+
+    // Corners of the TPC box used by Point_isInTPC and Line_clipToTPC, in cm
+    double _tpc_min[3];
+    double _tpc_max[3];
+
+    // Scratch space for Points_3Dto2D with a Points3D
+    mutable std::vector<float> _w_scratch;
+    mutable std::vector<float> _t_scratch;
+
     std::string _producer;
   
     // Store the reco data to draw;
     std::vector <std::vector<DATA_TYPE>> _dataByPlane;
+
+    // Grid of the bounding boxes of _dataByPlane, built on demand by getIndicesInWindow
+    std::vector<WindowIndex> _windowIndexByPlane;
   
     // Store the bounding parameters of interest:
     // highest and lowest wire, highest and lowest time
@@ -162,6 +272,26 @@ RecoBase<DATA_TYPE>::RecoBase(const geo::GeometryCore& geometry, const detinfo::
         _timeRange[plane].first  = 0;
         _timeRange[plane].second = _detProp.NumberTimeSamples();
     }
+
+    // WireCoordinate is affine in (y, z), sample it to get the coefficients:
+    _projectionByPlane.resize(_geoService.Nplanes());
+    for (size_t plane = 0; plane < _geoService.Nplanes(); plane++)
+    {
+        double pitch  = _geoService.WirePitch(plane);
+        double origin = _geoService.WireCoordinate(0, 0, plane, 0, 0) * pitch;
+        _projectionByPlane[plane].wire_y = _geoService.WireCoordinate(1, 0, plane, 0, 0) * pitch - origin;
+        _projectionByPlane[plane].wire_z = _geoService.WireCoordinate(0, 1, plane, 0, 0) * pitch - origin;
+        _projectionByPlane[plane].wire_offset = origin;
+    }
+
+    // The TPC box, in x it is extended by the drift distance of the trigger offset:
+    float timeToCm = _detProp.SamplingRate() / 1000.0 * _detProp.DriftVelocity(_detProp.Efield(), _detProp.Temperature());
+    _tpc_min[0] = - _geoService.DetHalfWidth() - _detProp.TriggerOffset() * timeToCm;
+    _tpc_max[0] =   _geoService.DetHalfWidth() + _detProp.TriggerOffset() * timeToCm;
+    _tpc_min[1] = - _geoService.DetHalfHeight();
+    _tpc_max[1] =   _geoService.DetHalfHeight();
+    _tpc_min[2] = 0.0;
+    _tpc_max[2] = _geoService.DetLength();
 }
 
 template <class DATA_TYPE> void RecoBase <DATA_TYPE>::setProducer(std::string s) 
@@ -224,6 +354,48 @@ template <class DATA_TYPE> const std::vector<DATA_TYPE> & RecoBase<DATA_TYPE>::g
   }
 }
 
+template <class DATA_TYPE> void RecoBase<DATA_TYPE>::_invalidateWindowIndex()
+{
+  for (auto & index : _windowIndexByPlane)
+    index.clear();
+}
+
+template <class DATA_TYPE>
+    std::vector<size_t> RecoBase<DATA_TYPE>::getIndicesInWindow(size_t p, float wmin, float wmax, float tmin, float tmax)
+{
+  std::vector<size_t> result;
+  if (p >= _geoService.Nplanes() || p >= _dataByPlane.size()) {
+    std::cerr << "ERROR: Request for nonexistent plane " << p << std::endl;
+    return result;
+  }
+
+  if (_windowIndexByPlane.size() != _dataByPlane.size())
+    _windowIndexByPlane.resize(_dataByPlane.size());
+
+  WindowIndex & index = _windowIndexByPlane[p];
+  if (!index.built()) {
+    std::vector<Box2D> boxes;
+    boxes.reserve(_dataByPlane[p].size());
+    for (auto const & data : _dataByPlane[p])
+      boxes.push_back(data.boundingBox());
+    index.build(boxes);
+  }
+
+  index.query(Box2D(wmin, wmax, tmin, tmax), result);
+  return result;
+}
+
+template <class DATA_TYPE>
+    std::vector<DATA_TYPE> RecoBase<DATA_TYPE>::getDataInWindow(size_t p, float wmin, float wmax, float tmin, float tmax)
+{
+  std::vector<DATA_TYPE> result;
+  std::vector<size_t> indices = getIndicesInWindow(p, wmin, wmax, tmin, tmax);
+  result.reserve(indices.size());
+  for (auto i : indices)
+    result.push_back(_dataByPlane[p][i]);
+  return result;
+}
+
 template <class DATA_TYPE> Point2D
     RecoBase<DATA_TYPE>::Point_3Dto2D(float x, float y, float z, unsigned int plane) const 
 {
@@ -231,7 +403,7 @@ template <class DATA_TYPE> Point2D
     Point2D returnPoint;
   
     // Make a check on the plane:
-    if (plane > _geoService.Nplanes()) {
+    if (plane >= _projectionByPlane.size()) {
         std::cerr << "ERROR: Can't project 3D point to unknown plane " << plane << std::endl;
         return returnPoint;
     }
@@ -243,7 +415,9 @@ template <class DATA_TYPE> Point2D
     // Previously used nearest wire functions, but they are
     // slightly inaccurate
     // If you want the nearest wire, use the nearest wire function!
-    returnPoint.w = _geoService.WireCoordinate(y, z, plane, 0, 0) * _geoService.WirePitch(plane);
+    // The coefficients are from _geoService.WireCoordinate(y, z, plane, 0, 0) * WirePitch(plane)
+    const PlaneProjection & projection = _projectionByPlane[plane];
+    returnPoint.w = projection.wire_y * y + projection.wire_z * z + projection.wire_offset;
     // std::cout << "wire is " << returnPoint.w << " (cm)" << std::endl;
   
     // The time position is the X coordinate, corrected for
@@ -277,6 +451,46 @@ template <class DATA_TYPE> Point2D
     return returnPoint;
 }
 
+template <class DATA_TYPE>
+    void RecoBase<DATA_TYPE>::Points_3Dto2D(const float * x, const float * y, const float * z, size_t n,
+                                            unsigned int plane, float * w, float * t) const
+{
+    if (plane >= _projectionByPlane.size()) {
+        std::cerr << "ERROR: Can't project 3D points to unknown plane " << plane << std::endl;
+        return;
+    }
+
+    const float wire_y = _projectionByPlane[plane].wire_y;
+    const float wire_z = _projectionByPlane[plane].wire_z;
+    const float wire_offset = _projectionByPlane[plane].wire_offset;
+
+    #pragma omp simd
+    for (size_t i = 0; i < n; i++) {
+        w[i] = wire_y * y[i] + wire_z * z[i] + wire_offset;
+        t[i] = x[i];
+    }
+}
+
+template <class DATA_TYPE>
+    void RecoBase<DATA_TYPE>::Points_3Dto2D(const Points3D & points, unsigned int plane,
+                                            std::vector<std::pair<float, float> > & result) const
+{
+    if (plane >= _projectionByPlane.size()) {
+        std::cerr << "ERROR: Can't project 3D points to unknown plane " << plane << std::endl;
+        return;
+    }
+
+    size_t n = points.size();
+    _w_scratch.resize(n);
+    _t_scratch.resize(n);
+    Points_3Dto2D(points.x.data(), points.y.data(), points.z.data(), n, plane,
+                  _w_scratch.data(), _t_scratch.data());
+
+    result.reserve(result.size() + n);
+    for (size_t i = 0; i < n; i++)
+        result.push_back(std::make_pair(_w_scratch[i], _t_scratch[i]));
+}
+
 template <class DATA_TYPE> 
     void RecoBase<DATA_TYPE>::Line_3Dto2D( const TVector3& startPoint3D, const TVector3& direction3D, unsigned int plane,
                                            Point2D& startPoint2D, Point2D& direction2D) const
@@ -287,13 +501,18 @@ template <class DATA_TYPE>
   //  std::cerr << "ERROR - GeometriaHelper::Line_3Dto2D: StartPoint3D must be in the TPC.\n";
   //  return;
   //}
-  // Next, get a second point in 3D:
-  float alpha = 10;
-  TVector3 secondPoint3D = startPoint3D + alpha * direction3D;
-  while ( ! Point_isInTPC(secondPoint3D) ) {
-    alpha *= -0.75;
-    secondPoint3D = startPoint3D + alpha * direction3D;
+  // Next, get a second point in 3D, on the part of the line inside the TPC:
+  double alpha = 10;
+  double s_min, s_max;
+  if (Line_clipToTPC(startPoint3D, direction3D, s_min, s_max)) {
+    alpha = std::min(std::max(alpha, s_min), s_max);
+    // The start point is on the edge and the line leaves the TPC there:
+    if (alpha == 0)
+      alpha = (s_min != 0) ? s_min : s_max;
+    if (alpha == 0)
+      alpha = 10;
   }
+  TVector3 secondPoint3D = startPoint3D + alpha * direction3D;
 
   // std::cout << "3D line is (" << startPoint3D.X() << ", " << startPoint3D.Y()
   //           << ", " << startPoint3D.Z() << ") to ( " << secondPoint3D.X()
@@ -328,21 +547,70 @@ template <class DATA_TYPE> float RecoBase<DATA_TYPE>::Slope_3Dto2D(float x, floa
   return slope.t / slope.w;
 }
 
-template <class DATA_TYPE> bool RecoBase<DATA_TYPE>::Point_isInTPC(const TVector3 & pointIn3D) const 
+template <class DATA_TYPE>
+    void RecoBase<DATA_TYPE>::Slopes_3Dto2D(const Points3D & directions, unsigned int plane, std::vector<float> & slopes) const
 {
-    float timeToCm = _detProp.SamplingRate() / 1000.0 * _detProp.DriftVelocity(_detProp.Efield(), _detProp.Temperature());
+  if (plane >= _projectionByPlane.size()) {
+    std::cerr << "ERROR: Can't project 3D directions to unknown plane " << plane << std::endl;
+    return;
+  }
+
+  // The projection is linear and the line of Slope_3Dto2D starts in the TPC, so
+  // its second point is a positive multiple of the direction away and the slope
+  // is the projected direction's: no clipping or point projection per direction
+  const float wire_y = _projectionByPlane[plane].wire_y;
+  const float wire_z = _projectionByPlane[plane].wire_z;
+
+  size_t n = directions.size();
+  slopes.resize(n);
+  const float * x = directions.x.data();
+  const float * y = directions.y.data();
+  const float * z = directions.z.data();
+  float * slope = slopes.data();
+
+  #pragma omp simd
+  for (size_t i = 0; i < n; i++)
+    slope[i] = x[i] / (wire_y * y[i] + wire_z * z[i]);
+}
+
+template <class DATA_TYPE>
+    bool RecoBase<DATA_TYPE>::Line_clipToTPC(const TVector3 & startPoint3D, const TVector3 & direction3D,
+                                             double & s_min, double & s_max) const
+{
+  s_min = - std::numeric_limits<double>::infinity();
+  s_max =   std::numeric_limits<double>::infinity();
+
+  const double start[3] = {startPoint3D.X(), startPoint3D.Y(), startPoint3D.Z()};
+  const double dir[3]   = {direction3D.X(), direction3D.Y(), direction3D.Z()};
+
+  for (int axis = 0; axis < 3; axis++) {
+    if (dir[axis] == 0) {
+      // Parallel to these faces, either always between them or never
+      if (start[axis] < _tpc_min[axis] || start[axis] > _tpc_max[axis])
+        return false;
+      continue;
+    }
+    double s1 = (_tpc_min[axis] - start[axis]) / dir[axis];
+    double s2 = (_tpc_max[axis] - start[axis]) / dir[axis];
+    s_min = std::max(s_min, std::min(s1, s2));
+    s_max = std::min(s_max, std::max(s1, s2));
+  }
+
+  return s_min <= s_max;
+}
 
+template <class DATA_TYPE> bool RecoBase<DATA_TYPE>::Point_isInTPC(const TVector3 & pointIn3D) const 
+{
     // Check against the 3 coordinates:
-    if (pointIn3D.X() > _geoService.DetHalfWidth() + _detProp.TriggerOffset() * timeToCm
-        || pointIn3D.X() < - _geoService.DetHalfWidth() - _detProp.TriggerOffset() * timeToCm)
+    if (pointIn3D.X() > _tpc_max[0] || pointIn3D.X() < _tpc_min[0])
     {
       return false;
     }
-    if (pointIn3D.Y() > _geoService.DetHalfHeight() || pointIn3D.Y() < - _geoService.DetHalfHeight() )
+    if (pointIn3D.Y() > _tpc_max[1] || pointIn3D.Y() < _tpc_min[1])
     {
       return false;
     }
-    if (pointIn3D.Z() > _geoService.DetLength() || pointIn3D.Z() < 0.0)
+    if (pointIn3D.Z() > _tpc_max[2] || pointIn3D.Z() < _tpc_min[2])
     {
       return false;
     }
@@ -0,0 +1,158 @@
+#ifndef EVD_WINDOWINDEX_CXX
+#define EVD_WINDOWINDEX_CXX
+
+#include "WindowIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace evd {
+
+// Largest grid, per axis
+static const size_t kMaxCells = 128;
+// Boxes touching more than this fraction of the cells go in the large list
+static const float kLargeFraction = 1.0 / 32;
+
+// NaN or infinite corners would not fit any cell, such boxes go in the large list
+static bool finite(const Box2D & box)
+{
+  return std::isfinite(box.w_min) && std::isfinite(box.w_max) &&
+         std::isfinite(box.t_min) && std::isfinite(box.t_max);
+}
+
+WindowIndex::WindowIndex() :
+  _built(false),
+  _n_w(1),
+  _n_t(1),
+  _cell_w(1),
+  _cell_t(1)
+{}
+
+void WindowIndex::clear()
+{
+  _built = false;
+  _boxes.clear();
+  _offsets.clear();
+  _entries.clear();
+  _large.clear();
+}
+
+size_t WindowIndex::cell_w(float w) const
+{
+  float c = (w - _bounds.w_min) / _cell_w;
+  // Written so that NaN goes to the first cell too
+  if (!(c >= 0)) return 0;
+  if (c >= _n_w) return _n_w - 1;
+  return c;
+}
+
+size_t WindowIndex::cell_t(float t) const
+{
+  float c = (t - _bounds.t_min) / _cell_t;
+  // Written so that NaN goes to the first cell too
+  if (!(c >= 0)) return 0;
+  if (c >= _n_t) return _n_t - 1;
+  return c;
+}
+
+void WindowIndex::build(const std::vector<Box2D> & boxes)
+{
+  clear();
+  _boxes = boxes;
+  _built = true;
+
+  _bounds = Box2D();
+  size_t n_boxes = 0;
+  for (auto const & box : _boxes) {
+    if (box.empty() || !finite(box)) continue;
+    _bounds.extend(box);
+    n_boxes ++;
+  }
+
+  // About one box per cell
+  size_t n_side = std::ceil(std::sqrt((float) n_boxes));
+  n_side = std::max(std::min(n_side, kMaxCells), (size_t) 1);
+  _n_w = n_side;
+  _n_t = n_side;
+  _cell_w = (_bounds.w_max - _bounds.w_min) / _n_w;
+  _cell_t = (_bounds.t_max - _bounds.t_min) / _n_t;
+  if (!(_cell_w > 0)) _cell_w = 1;
+  if (!(_cell_t > 0)) _cell_t = 1;
+
+  // Count, then fill, the boxes of each cell
+  std::vector<size_t> counts(_n_w * _n_t + 1, 0);
+  std::vector<bool> large(_boxes.size(), false);
+  for (size_t i = 0; i < _boxes.size(); i++) {
+    const Box2D & box = _boxes[i];
+    if (box.empty()) continue;
+    if (!finite(box)) {
+      large[i] = true;
+      _large.push_back(i);
+      continue;
+    }
+    size_t w0 = cell_w(box.w_min), w1 = cell_w(box.w_max);
+    size_t t0 = cell_t(box.t_min), t1 = cell_t(box.t_max);
+    if ((w1 - w0 + 1) * (t1 - t0 + 1) > kLargeFraction * _n_w * _n_t && _n_w * _n_t > 4) {
+      large[i] = true;
+      _large.push_back(i);
+      continue;
+    }
+    for (size_t w = w0; w <= w1; w++)
+      for (size_t t = t0; t <= t1; t++)
+        counts[w * _n_t + t + 1] ++;
+  }
+
+  _offsets.resize(counts.size());
+  _offsets[0] = 0;
+  for (size_t c = 1; c < counts.size(); c++)
+    _offsets[c] = _offsets[c - 1] + counts[c];
+
+  _entries.resize(_offsets.back());
+  std::vector<size_t> next(_offsets.begin(), _offsets.end() - 1);
+  for (size_t i = 0; i < _boxes.size(); i++) {
+    const Box2D & box = _boxes[i];
+    if (box.empty() || large[i]) continue;
+    size_t w0 = cell_w(box.w_min), w1 = cell_w(box.w_max);
+    size_t t0 = cell_t(box.t_min), t1 = cell_t(box.t_max);
+    for (size_t w = w0; w <= w1; w++)
+      for (size_t t = t0; t <= t1; t++)
+        _entries[next[w * _n_t + t] ++] = i;
+  }
+}
+
+void WindowIndex::query(const Box2D & window, std::vector<size_t> & result) const
+{
+  result.clear();
+  if (!_built || window.empty() || !window.overlaps(_bounds))
+    return;
+
+  size_t w0 = cell_w(window.w_min), w1 = cell_w(window.w_max);
+  size_t t0 = cell_t(window.t_min), t1 = cell_t(window.t_max);
+
+  for (size_t w = w0; w <= w1; w++) {
+    for (size_t t = t0; t <= t1; t++) {
+      size_t cell = w * _n_t + t;
+      for (size_t e = _offsets[cell]; e < _offsets[cell + 1]; e++) {
+        const Box2D & box = _boxes[_entries[e]];
+        if (!box.overlaps(window)) continue;
+        // A box is in several cells, report it only from the cell holding the
+        // lower corner of its overlap with the window
+        if (cell_w(std::max(box.w_min, window.w_min)) != w ||
+            cell_t(std::max(box.t_min, window.t_min)) != t)
+          continue;
+        result.push_back(_entries[e]);
+      }
+    }
+  }
+
+  for (auto i : _large) {
+    if (_boxes[i].overlaps(window))
+      result.push_back(i);
+  }
+
+  std::sort(result.begin(), result.end());
+}
+
+} // evd
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * \file WindowIndex.h
+ *
+ * \ingroup RecoViewer
+ *
+ * \brief Class def header for a class WindowIndex
+ *
+ * Uniform grid over the bounding boxes of the 2D objects of one plane, to
+ * find the ones that overlap the part of the plane that is on screen.
+ *
+ * @author cadams
+ */
+
+/** \addtogroup RecoViewer
+
+    @{*/
+#ifndef EVD_WINDOWINDEX_H
+#define EVD_WINDOWINDEX_H
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace evd {
+
+/// Axis aligned box in (wire, time), in the units of the object it bounds
+class Box2D {
+
+public:
+
+  /// Empty box, grows with extend
+  Box2D() :
+    w_min(std::numeric_limits<float>::max()),
+    w_max(-std::numeric_limits<float>::max()),
+    t_min(std::numeric_limits<float>::max()),
+    t_max(-std::numeric_limits<float>::max())
+  {}
+
+  Box2D(float wmin, float wmax, float tmin, float tmax) :
+    w_min(wmin), w_max(wmax), t_min(tmin), t_max(tmax)
+  {}
+
+  bool empty() const {return w_min > w_max || t_min > t_max;}
+
+  bool overlaps(const Box2D & other) const {
+    return w_min <= other.w_max && other.w_min <= w_max &&
+           t_min <= other.t_max && other.t_min <= t_max;
+  }
+
+  void extend(float w, float t) {
+    if (w < w_min) w_min = w;
+    if (w > w_max) w_max = w;
+    if (t < t_min) t_min = t;
+    if (t > t_max) t_max = t;
+  }
+
+  void extend(const Box2D & other) {
+    if (other.empty()) return;
+    extend(other.w_min, other.t_min);
+    extend(other.w_max, other.t_max);
+  }
+
+  float w_min;
+  float w_max;
+  float t_min;
+  float t_max;
+};
+
+/**
+   \class WindowIndex
+   Each object is listed in every grid cell its box touches, cell by cell
+   back to back (CSR).  Objects that cover a large part of the grid, like a
+   track across the whole plane, or with NaN or infinite corners, are kept in
+   a separate list and always tested.
+ */
+class WindowIndex {
+
+public:
+
+  WindowIndex();
+
+  /// Index these boxes, replacing what was there
+  void build(const std::vector<Box2D> & boxes);
+
+  /// Forget the boxes, built() is false until the next build
+  void clear();
+
+  bool built() const {return _built;}
+
+  /**
+   * @brief Indices of the boxes that overlap the window
+   *
+   * @param window The region to look in
+   * @param result Returned: the indices given to build, in increasing order
+   */
+  void query(const Box2D & window, std::vector<size_t> & result) const;
+
+private:
+
+  size_t cell_w(float w) const;
+  size_t cell_t(float t) const;
+
+  bool _built;
+
+  std::vector<Box2D> _boxes;
+
+  // The grid covers _bounds with _n_w x _n_t cells
+  Box2D _bounds;
+  size_t _n_w;
+  size_t _n_t;
+  float _cell_w;
+  float _cell_t;
+
+  // Boxes in cell c are _entries[_offsets[c]] to _entries[_offsets[c+1] - 1]
+  std::vector<size_t> _offsets;
+  std::vector<size_t> _entries;
+
+  // Boxes too large for the grid
+  std::vector<size_t> _large;
+
+};
+
+} // evd
+
+#endif
+/** @} */ // end of doxygen group
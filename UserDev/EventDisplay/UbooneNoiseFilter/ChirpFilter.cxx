@@ -21,114 +21,185 @@ bool ChirpFilter::ChirpFilterAlg(float * wf, int numTicks)
 
   _current_chirp_info = chirp_info();
 
-  int counter = 0;
-  double ADCval;
-  double runningAmpMean = 0.0;
-  double runningAmpRMS = 0.0;
+  int numWindows = numTicks / windowSize;
+  if (numWindows == 0) {
+    return false;
+  }
+  if (_window_rms.size() < (size_t) numWindows) {
+    _window_rms.resize(numWindows);
+    _window_sum2.resize(numWindows);
+  }
+
+  compute_window_rms(wf, numTicks, &(_window_rms[0]), &(_window_sum2[0]));
+
+  return find_chirp_range(wf, numTicks, &(_window_rms[0]), _current_chirp_info);
+}
+
+int ChirpFilter::ChirpFilterPlane(float * _plane_data,
+                                  int n_wires,
+                                  int numTicks,
+                                  std::vector<chirp_info> & _chirp_info_v)
+{
+
+  _chirp_info_v.assign(n_wires, chirp_info());
+
+  int numWindows = numTicks / windowSize;
+  if (numWindows == 0) {
+    return 0;
+  }
+
+  if (_window_rms.size() < (size_t) (wireBlockSize * numWindows)) {
+    _window_rms.resize(wireBlockSize * numWindows);
+    _window_sum2.resize(wireBlockSize * numWindows);
+  }
+
+  int n_chirping = 0;
+
+  for (int block_start = 0; block_start < n_wires; block_start += wireBlockSize) {
+
+    int block_end = std::min(n_wires, block_start + wireBlockSize);
+
+    // First pass: the window RMS of every wire in the block.
+    // This is the only part that touches every tick.
+    for (int wire = block_start; wire < block_end; wire ++) {
+      compute_window_rms(_plane_data + (size_t) wire * numTicks,
+                         numTicks,
+                         &(_window_rms[(wire - block_start) * numWindows]),
+                         &(_window_sum2[(wire - block_start) * numWindows]));
+    }
+
+    // Second pass: the chirp logic, only over the window values.
+    for (int wire = block_start; wire < block_end; wire ++) {
+      if (find_chirp_range(_plane_data + (size_t) wire * numTicks,
+                           numTicks,
+                           &(_window_rms[(wire - block_start) * numWindows]),
+                           _chirp_info_v[wire])) {
+        n_chirping ++;
+      }
+    }
+  }
+
+  return n_chirping;
+}
+
+void ChirpFilter::compute_window_rms(const float * wf,
+                                     int numTicks,
+                                     float * _rms,
+                                     float * _sum2) const
+{
+
+  int numWindows = numTicks / windowSize;
+
+  // Sums over each window.  The reduction over the window is the
+  // only loop that touches every tick, keep it simple enough to vectorize.
+  for (int window = 0; window < numWindows; window ++) {
+
+    const float * x = wf + window * windowSize;
+    const float ref = x[0];
+
+    float sum = 0.0;
+    float sum2 = 0.0;
+    #pragma omp simd reduction(+:sum,sum2)
+    for (int tick = 0; tick < windowSize; tick ++) {
+      float d = x[tick] - ref;
+      sum += d;
+      sum2 += d * d;
+    }
+
+    _rms[window] = sum;
+    _sum2[window] = sum2;
+  }
+
+  // RMS = sqrt(N*sum2 - sum*sum) / N, done over all windows at once
+  for (int window = 0; window < numWindows; window ++) {
+    float var = windowSize * _sum2[window] - _rms[window] * _rms[window];
+    _rms[window] = std::sqrt(var > 0 ? var : 0.0f) / windowSize;
+  }
+
+}
+
+bool ChirpFilter::find_chirp_range(float * wf,
+                                   int numTicks,
+                                   const float * _rms,
+                                   chirp_info & info) const
+{
+
+  int numWindows = numTicks / windowSize;
   int numLowRMS = 0;
   int firstLowRMSBin = -1;
   int lastLowRMSBin = -1;
   bool lowRMSFlag = false;
-  double RMSfirst = 0.0;
-  double RMSsecond = 0.0;
-  double RMSthird = 0.0;
+  float RMSfirst = 0.0;
+  float RMSsecond = 0.0;
+  float RMSthird = 0.0;
   int numNormalNeighbors = 0;
 
 
-  // Loop over the whole waveform.
-  for (int i = 0; i < numTicks; i++)
+  // Loop over the windows.  i is the last tick of the window,
+  // matching the original tick by tick loop.
+  for (int window = 0; window < numWindows; window ++)
   {
-    // Get the current tick value
-    ADCval = wf[i];
+    int i = (window + 1) * windowSize - 1;
 
-    // The running mean and RMS are used to compare mean and rms between windows
-    runningAmpMean += ADCval;
-    runningAmpRMS += ADCval * ADCval;
+    RMSfirst = RMSsecond;
+    RMSsecond = RMSthird;
+    RMSthird = _rms[window];
 
-    // Counter keeps track of where within the window this tick is
-    counter++;
-    if (counter == windowSize)
+    // A very low RMS indicates chirping (or otherwise dead wire) in this region
+    if (RMSthird < chirpMinRMS)
     {
-      // counter == windowSize means we've hit the tick at the edge of the window
-
-      // Finish Calculating the mean and RMS
-      runningAmpMean /= (double)windowSize;
-      runningAmpRMS /= (double)windowSize;
-      // std::cout << "runningAmpRMS - runningAmpMean * runningAmpMean  " << runningAmpRMS - runningAmpMean * runningAmpMean << std::endl;
-
-      if (runningAmpRMS - runningAmpMean * runningAmpMean < 0) {
-        std::cout << runningAmpRMS - runningAmpMean * runningAmpMean << std::endl;
-        exit(-1);
-      }
-
-      runningAmpRMS = sqrt(runningAmpRMS - runningAmpMean * runningAmpMean);
-
-      RMSfirst = RMSsecond;
-      RMSsecond = RMSthird;
-      RMSthird = runningAmpRMS;
+      numLowRMS++;
+    }
 
-      // A very low RMS indicates chirping (or otherwise dead wire) in this region
-      // std::cout << "runningAmpRMS 2 " << runningAmpRMS << std::endl;
-      if (runningAmpRMS < chirpMinRMS)
+    // This asks if we are in a window that is at least 3 windows in from the edge
+    if (i >= 3 * windowSize )
+    {
+      // This asks if the middle RMS is below chirp threshold while either of it's
+      // neighbors are above threshold.
+      // This indicates a chirping transition I think
+      if ( (RMSsecond < chirpMinRMS) &&
+           ((RMSfirst > chirpMinRMS) ||
+            (RMSthird > chirpMinRMS)
+           )
+         )
       {
-        numLowRMS++;
+        numNormalNeighbors++;
       }
 
-      // This asks if we are in a window that is at least 3 windows in from the edge
-      if (i >= 3 * windowSize )
-        // if (i >= 3 * windowSize - 1)
+      if (lowRMSFlag == false)
       {
-        // This asks if the middle RMS is below chirp threshold while either of it's
-        // neighbors are above threshold.
-        // This indicates a chirping transition I think
-        if ( (RMSsecond < chirpMinRMS) &&
-             ((RMSfirst > chirpMinRMS) ||
-              (RMSthird > chirpMinRMS)
-             )
+        if (((RMSsecond < chirpMinRMS) &&
+             (RMSthird < chirpMinRMS2)) ||
+            ((RMSsecond < chirpMinRMS2) &&
+             (RMSthird < chirpMinRMS))
            )
         {
-          numNormalNeighbors++;
+          lowRMSFlag = true;
+          firstLowRMSBin = i - 2 * windowSize + 1;
+          lastLowRMSBin = i - windowSize + 1;
         }
 
-        if (lowRMSFlag == false)
+        if ((i == 3 * windowSize) &&
+            (((RMSfirst < chirpMinRMS) &&
+              (RMSsecond < chirpMinRMS2)) ||
+             ((RMSfirst < chirpMinRMS2) &&
+              (RMSsecond < chirpMinRMS))))
         {
-          if (((RMSsecond < chirpMinRMS) &&
-               (RMSthird < chirpMinRMS2)) ||
-              ((RMSsecond < chirpMinRMS2) &&
-               (RMSthird < chirpMinRMS))
-             )
-          {
-            lowRMSFlag = true;
-            firstLowRMSBin = i - 2 * windowSize + 1;
-            lastLowRMSBin = i - windowSize + 1;
-          }
-
-          if ((i == 3 * windowSize) &&
-              (((RMSfirst < chirpMinRMS) &&
-                (RMSsecond < chirpMinRMS2)) ||
-               ((RMSfirst < chirpMinRMS2) &&
-                (RMSsecond < chirpMinRMS))))
-          {
-            lowRMSFlag = true;
-            firstLowRMSBin = i - 3 * windowSize + 1;
-            lastLowRMSBin = i - 2 * windowSize + 1;
-          }
+          lowRMSFlag = true;
+          firstLowRMSBin = i - 3 * windowSize + 1;
+          lastLowRMSBin = i - 2 * windowSize + 1;
         }
-        else
+      }
+      else
+      {
+        if (((RMSsecond < chirpMinRMS) &&
+             (RMSthird < chirpMinRMS2)) ||
+            ((RMSsecond < chirpMinRMS2) &&
+             (RMSthird < chirpMinRMS)))
         {
-          if (((RMSsecond < chirpMinRMS) &&
-               (RMSthird < chirpMinRMS2)) ||
-              ((RMSsecond < chirpMinRMS2) &&
-               (RMSthird < chirpMinRMS)))
-          {
-            lastLowRMSBin = i - windowSize + 1;
-          }
+          lastLowRMSBin = i - windowSize + 1;
         }
       }
-
-      counter = 0;
-      runningAmpMean = 0.0;
-      runningAmpRMS = 0.0;
     }
   }
 
@@ -136,17 +207,6 @@ bool ChirpFilter::ChirpFilterAlg(float * wf, int numTicks)
   float chirpFrac = ((float) numLowRMS) / (((float) numTicks) / ((float) windowSize));
   float normalNeighborFrac = ((float) numNormalNeighbors) / ((float) numLowRMS);
 
-  // std::cout << "numTicks " << numTicks << std::endl;
-  // std::cout << "windowSize " << windowSize << std::endl;
-  // std::cout << "numNormalNeighbors " << numNormalNeighbors << std::endl;
-  // std::cout << "numLowRMS " << numLowRMS << std::endl;
-
-  // std::cout << "chirpFrac " << chirpFrac << std::endl;
-  // std::cout << "normalNeighborFrac " << normalNeighborFrac << std::endl;
-  // std::cout << "lastLowRMSBin " << lastLowRMSBin << std::endl;
-  // std::cout << "firstLowRMSBin " << firstLowRMSBin << std::endl;
-
-
   if (((normalNeighborFrac < maxNormalNeighborFrac) ||
        ((numLowRMS < 2.0 / maxNormalNeighborFrac) &&
         (lastLowRMSBin - firstLowRMSBin == numLowRMS * windowSize))
@@ -168,18 +228,12 @@ bool ChirpFilter::ChirpFilterAlg(float * wf, int numTicks)
       firstLowRMSBin = std::max(0, firstLowRMSBin - 100);
     }
 
-
-
-    // if ((numTicks - lastLowRMSBin) < windowSize)
-    // {
-    //   lastLowRMSBin = numTicks;
-    // }
-    // chirpFrac = 1.0 * (lastLowRMSBin - firstLowRMSBin) / numTicks;
-
     if (lastLowRMSBin - firstLowRMSBin > 0.9 * numTicks) {
       chirpFrac = 1.0;
     }
 
+    info.chirping = true;
+
     if (chirpFrac > 0.990)
     {
       firstLowRMSBin = 0;
@@ -188,9 +242,9 @@ bool ChirpFilter::ChirpFilterAlg(float * wf, int numTicks)
       //////////////////////////////////////////////////
       // Set channel status to "DEAD" (LOW-RMS?) here //
       //////////////////////////////////////////////////
-      _current_chirp_info.chirp_start = 0;
-      _current_chirp_info.chirp_stop = numTicks;
-      _current_chirp_info.chirp_frac = 1.0;
+      info.chirp_start = 0;
+      info.chirp_stop = numTicks;
+      info.chirp_frac = 1.0;
     }
     else
     {
@@ -198,19 +252,13 @@ bool ChirpFilter::ChirpFilterAlg(float * wf, int numTicks)
       // Set channel status to "MID-CHIRPING" here //
       ///////////////////////////////////////////////
 
-      _current_chirp_info.chirp_start = firstLowRMSBin;
-      _current_chirp_info.chirp_stop = lastLowRMSBin;
-      _current_chirp_info.chirp_frac = chirpFrac;
+      info.chirp_start = firstLowRMSBin;
+      info.chirp_stop = lastLowRMSBin;
+      info.chirp_frac = chirpFrac;
 
     }
 
-    for (int i = 0; i < numTicks; i++)
-    {
-      if ((i >= firstLowRMSBin) && (i < lastLowRMSBin))
-      {
-        wf[i] = 0.0;
-      }
-    }
+    std::fill(wf + firstLowRMSBin, wf + lastLowRMSBin, 0.0);
   } else {
     return false;
   }
@@ -219,59 +267,52 @@ bool ChirpFilter::ChirpFilterAlg(float * wf, int numTicks)
 }
 
 void ChirpFilter::remove_baseline_deviation(float * wf, int numTicks) const {
+  remove_baseline_deviation(wf, numTicks, _current_chirp_info);
+}
+
+void ChirpFilter::remove_baseline_deviation(float * wf,
+                                            int numTicks,
+                                            const chirp_info & info) const {
 
   // Remove the baseline deviation in this wire caused by chirping.
   //
   // If the wire starts ok, and then starts chriping, that's
 
   // If the wire is chirping at the start, fix it.  Otherwise, return
-  if ( _current_chirp_info.chirp_start == 0 &&
-       _current_chirp_info.chirp_stop != 9595 ) {
+  int chirp_stop = info.chirp_stop;
+  if ( info.chirp_start == 0 &&
+       chirp_stop < numTicks ) {
 
     // take the amplitude at the start of the chirping
     // and subtract the exponential from the start.
 
-    // Get the start amplitude:
-    double integral = 0.0;
-    double n_integral = 0;
-    double baseline = 0.0;
-    double n_baseline = 0;
     // Find the amplitude by integrating the first time-constant range
-    // of the waveform.
-    for (int tick = 0; tick < chirp_rc_const; tick ++ ) {
-      if (_current_chirp_info.chirp_stop + tick < numTicks) {
-        integral += wf[_current_chirp_info.chirp_stop + tick];
-        n_integral ++;
-      }
-    }
-
-    for (int tick = numTicks;
-         tick > _current_chirp_info.chirp_stop + chirp_rc_const &&
-         tick > numTicks - chirp_rc_const;
-         tick --) {
-      baseline += wf[tick];
-      n_baseline ++;
+    // of the waveform after the chirping.
+    int integral_end = std::min(numTicks, chirp_stop + (int) chirp_rc_const);
+    double n_integral = integral_end - chirp_stop;
+    double integral = window_sum(wf, chirp_stop, integral_end);
+
+    // The baseline is the average of the last time-constant range,
+    // as long as that doesn't overlap the integral range.
+    int baseline_start = std::max(chirp_stop + (int) chirp_rc_const,
+                                  numTicks - (int) chirp_rc_const);
+    if (baseline_start >= numTicks) {
+      return;
     }
+    double baseline = window_sum(wf, baseline_start, numTicks) / (numTicks - baseline_start);
 
     // If the amplitude of the exponential is A, then the integral is A*tau*(1 - e^-(n/tau))
     // In this case, there is a baseline correction as well.
     // So, the integral is baseline*N + A*tau*(1-e^(-n/tau))
 
-    baseline /= n_baseline;
-
     double amplitude = integral - n_integral * baseline;
 
     amplitude /= (chirp_rc_const * (1 - exp(-n_integral / chirp_rc_const))  );  // Now == A
 
 
     // Now subtract the exponential from the waveform:
-    for (int tick = _current_chirp_info.chirp_stop; tick < numTicks; tick ++ ) {
-      size_t exp_tick = tick - _current_chirp_info.chirp_stop;
-      if (exp_tick >= 4000)
-        break;
-      wf[tick] -= (amplitude) * chirp_exponential[exp_tick];
-    }
-
+    int n_subtract = std::min(numTicks - chirp_stop, (int) chirp_exponential.size());
+    subtract_scaled(wf + chirp_stop, &(chirp_exponential[0]), n_subtract, amplitude);
 
   }
 
@@ -46,8 +46,11 @@
 #include <iostream>
 #include <vector>
 #include <math.h>
+#include <cmath>
+#include <algorithm>
 
 #include "NoiseFilterTypes.h"
+#include "WaveformKernels.h"
 
 /**
    \class ChirpFilter
@@ -69,12 +72,62 @@ public:
 
   bool ChirpFilterAlg(float * wf, int numTicks);
 
+  /**
+   * @brief Run the chirp detection over every wire in a plane
+   * @details The windowed RMS is computed for a block of wires at a time
+   *          in single precision, in loops simple enough to vectorize.  The (branchy) chirp decision then only runs over
+   *          the compact array of window RMS values, not over every tick.
+   *          Chirping regions are zeroed in place, as in ChirpFilterAlg.
+   *
+   * @param _plane_data Pointer to the plane data, wires concatenated
+   * @param n_wires Number of wires in the plane
+   * @param numTicks Number of ticks in each wire
+   * @param _chirp_info_v Output, resized to n_wires.  Wires that are not
+   *                      chirping have chirping == false.
+   * @return The number of chirping wires in this plane
+   */
+  int ChirpFilterPlane(float * _plane_data,
+                       int n_wires,
+                       int numTicks,
+                       std::vector<chirp_info> & _chirp_info_v);
+
   void remove_baseline_deviation(float * wf, int numTicks) const;
 
+  void remove_baseline_deviation(float * wf, int numTicks, const chirp_info & info) const;
+
   chirp_info & get_current_chirp_info() {return _current_chirp_info;}
 
 private:
 
+  /**
+   * @brief Compute the RMS of each non overlapping window of a waveform
+   * @details Each window is shifted by its first sample before accumulating,
+   *          which keeps the single precision sums well conditioned even
+   *          on waveforms that are not pedestal subtracted.
+   *
+   * @param wf The waveform
+   * @param numTicks Number of ticks in the waveform
+   * @param _rms Output, must hold numTicks / windowSize values
+   * @param _sum2 Scratch space of the same size as _rms
+   */
+  void compute_window_rms(const float * wf, int numTicks, float * _rms, float * _sum2) const;
+
+  /**
+   * @brief Decide if a waveform is chirping from its window RMS values
+   * @details This is the window logic of ChirpFilterAlg.  If the wire is chirping,
+   *          the chirp region of wf is zeroed and info is filled.
+   *
+   * @return true if the waveform is chirping
+   */
+  bool find_chirp_range(float * wf, int numTicks, const float * _rms, chirp_info & info) const;
+
+  // Number of wires handled per block by ChirpFilterPlane
+  const int wireBlockSize = 64;
+
+  // Scratch space for the window sums, reused between calls
+  std::vector<float> _window_rms;
+  std::vector<float> _window_sum2;
+
   const int windowSize = 20;
   const float chirpMinRMS = 0.90;
   const float chirpMinRMS2 = 0.66;
@@ -3,8 +3,15 @@
 
 #include "CorrelatedNoiseFilter.h"
 
+#include <algorithm>
+
 namespace ub_noise_filter {
 
+void CorrelatedNoiseFilter::init(const detPropFetcher & detector) {
+  _detector_properties_interface = detector;
+  reset();
+}
+
 void CorrelatedNoiseFilter::reset() {
   _correlatedNoiseWaveforms.clear();
   _correlatedNoiseWaveforms.resize(_detector_properties_interface.n_planes());
@@ -35,16 +42,7 @@ void CorrelatedNoiseFilter::remove_correlated_noise(
   }
 
   // First, need to know what block this wire came from:
-  size_t i_block;
-  for (i_block = 0;
-       i_block < _detector_properties_interface.correlated_noise_blocks(plane).size();
-       i_block ++)
-  {
-    if (_detector_properties_interface.correlated_noise_blocks(plane).at(i_block + 1) > wire) {
-      // Then the block is the correct one!
-      break;
-    }
-  }
+  size_t i_block = _detector_properties_interface.block(plane, wire);
 
   // Now subtract the waveform from this wire
   int start_tick = 0;
@@ -52,16 +50,17 @@ void CorrelatedNoiseFilter::remove_correlated_noise(
 
 
 
-  if (_chirp_info_ptr -> at(plane).find(wire) != _chirp_info_ptr -> at(plane).end()) {
+  const chirp_info & _chirp = _chirp_info_ptr -> at(plane)[wire];
+  if (_chirp.chirping) {
     // this wire IS chirping, so only use the good range:
     // Either start or the end of the wire will be one range of the chirping.
-    if (_chirp_info_ptr -> at(plane)[wire].chirp_start == 0) {
-      start_tick = _chirp_info_ptr -> at(plane)[wire].chirp_stop;
+    if (_chirp.chirp_start == 0) {
+      start_tick = _chirp.chirp_stop;
       end_tick = N;
     }
     else {
       start_tick = 0.0;
-      end_tick = _chirp_info_ptr -> at(plane)[wire].chirp_start;
+      end_tick = _chirp.chirp_start;
     }
   }
   else {
@@ -104,7 +103,9 @@ void CorrelatedNoiseFilter::build_noise_waveforms(
   _harmonicNoiseWaveforms.at(plane).resize(_n_time_ticks_data);
 
   // First build a guess at the harmonic noise waveforms:
-  build_harmonic_noise_waveform(_plane_data, plane, _n_time_ticks_data);
+  if (_remove_harmonic_noise) {
+    build_harmonic_noise_waveform(_plane_data, plane, _n_time_ticks_data);
+  }
 
   // Build uncorrected correlated noise waveforms
   build_coherent_noise_waveforms(_plane_data, plane, _n_time_ticks_data);
@@ -184,9 +185,7 @@ void CorrelatedNoiseFilter::build_harmonic_noise_waveform(
   int _n_time_ticks_data)
 {
 
-  // Only consider wires that are full length wires:
-  double _min_length = _max_wire_lengths[plane];
-
+  // Only consider wires that are full length wires (see below)
   std::vector<float> harmonic_noise;
   harmonic_noise.resize(_n_time_ticks_data);
 
@@ -206,18 +205,9 @@ void CorrelatedNoiseFilter::build_harmonic_noise_waveform(
     {
 
       // Need to know which correlated noise block this wire is from:
-      size_t i_block;
-      for (i_block = 0;
-           i_block < _detector_properties_interface.correlated_noise_blocks(plane).size();
-           i_block ++)
-      {
-        if (_detector_properties_interface.correlated_noise_blocks(plane).at(i_block + 1) > wire) {
-          // Then the block is the correct one!
-          break;
-        }
-      }
+      size_t i_block = _detector_properties_interface.block(plane, wire);
 
-      if (_detector_properties_interface.wire_length(plane, wire) >= _min_length) {
+      if (_detector_properties_interface.is_full_length(plane, wire)) {
         int offset = wire * _n_time_ticks_data;
         auto _data_val = _plane_data[offset + tick] -
                          _correlatedNoiseWaveforms[plane][i_block][tick];
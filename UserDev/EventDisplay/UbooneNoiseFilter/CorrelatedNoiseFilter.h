@@ -35,7 +35,16 @@ class CorrelatedNoiseFilter {
 public:
 
   /// Default constructor
-  CorrelatedNoiseFilter() {_detector_properties_interface.init();}
+  CorrelatedNoiseFilter() {}
+
+  /**
+   * @brief Take the detector layout
+   * @details Must be called before any other method, the geometry is not
+   *          touched at construction.
+   *
+   * @param detector The layout, already initialized, it is copied
+   */
+  void init(const detPropFetcher & detector);
 
   /// Default destructor
   ~CorrelatedNoiseFilter() {}
@@ -56,6 +65,14 @@ public:
                                unsigned int plane);
 
 
+  /**
+   * @brief Turn the time domain harmonic noise estimate on or off
+   * @details On by default.  When off, the harmonic noise waveforms stay at
+   *          zero; used when the harmonic noise is removed in the frequency
+   *          domain instead (see FrequencyNoiseFilter).
+   */
+  void set_harmonic_noise_removal(bool _doit) {_remove_harmonic_noise = _doit;}
+
   /**
    * @brief Reset the algorithm
    * @details Clear internal stored data for correlated and harmonic noise
@@ -144,7 +161,7 @@ public:
    *
    * @param _ptr Pointer to wire chirp information from the main noise filter
    */
-  void set_chirp_info_pointer(std::vector<std::map<int, ::ub_noise_filter::chirp_info> >  * _ptr) {
+  void set_chirp_info_pointer(std::vector<std::vector<chirp_info> >  * _ptr) {
     _chirp_info_ptr = _ptr;
   }
 
@@ -159,9 +176,9 @@ public:
   std::vector<std::vector<float > >
   getCorrelatedNoiseBlocks() const {
     std::vector<std::vector<float> > _blocks;
-    _blocks.push_back(_detector_properties_interface.correlated_noise_blocks(0));
-    _blocks.push_back(_detector_properties_interface.correlated_noise_blocks(1));
-    _blocks.push_back(_detector_properties_interface.correlated_noise_blocks(2));
+    for (unsigned int plane = 0; plane < _detector_properties_interface.n_planes(); plane ++) {
+      _blocks.push_back(_detector_properties_interface.correlated_noise_blocks(plane));
+    }
     return _blocks;
   }
 
@@ -182,8 +199,9 @@ private:
 
   // Also store the harmonic noise waveforms for each plane:
   std::vector<std::vector<float> > _harmonicNoiseWaveforms;
+  bool _remove_harmonic_noise = true;
 
-  std::vector<std::map<int, ::ub_noise_filter::chirp_info> >  * _chirp_info_ptr;
+  std::vector<std::vector<chirp_info> >  * _chirp_info_ptr;
 
 
   // This is a pointer to the wire status vector from the main noise filter algorithm
@@ -203,8 +221,6 @@ private:
   std::vector<float> rms_minimum = {30.0, 50.0, 50.0};
   std::vector<int> windowsize = {100, 50, 50};
 
-  const std::vector<float> _max_wire_lengths = { 456.9, 465.9, 233.0};
-
 };
 
 }
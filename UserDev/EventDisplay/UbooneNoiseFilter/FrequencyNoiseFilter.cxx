@@ -0,0 +1,203 @@
+#ifndef FREQUENCYNOISEFILTER_CXX
+#define FREQUENCYNOISEFILTER_CXX
+
+#include "FrequencyNoiseFilter.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "TVirtualFFT.h"
+
+namespace ub_noise_filter {
+
+FrequencyNoiseFilter::FrequencyNoiseFilter() :
+  _n_threads(0),
+  _sampling_frequency(2.0),
+  _mask_ticks(0),
+  _plan_ticks(0),
+  _pool(0)
+{}
+
+FrequencyNoiseFilter::~FrequencyNoiseFilter() {
+  for (auto & _ws : _workspaces) {
+    delete _ws.forward;
+    delete _ws.backward;
+  }
+  delete _pool;
+}
+
+void FrequencyNoiseFilter::init(const detPropFetcher & detector) {
+  _detector_properties_interface = detector;
+
+  _notches_by_plane.resize(_detector_properties_interface.n_planes());
+  _low_frequency_cut_by_plane.resize(_detector_properties_interface.n_planes(), 0.0);
+  _mask_ticks = 0;
+
+  delete _pool;
+  _pool = new galleryfmwk::threadpool(_n_threads);
+
+  // New plans are needed, one per thread:
+  for (auto & _ws : _workspaces) {
+    delete _ws.forward;
+    delete _ws.backward;
+  }
+  _workspaces.clear();
+  _plan_ticks = 0;
+}
+
+void FrequencyNoiseFilter::add_notch(unsigned int plane, float f_low, float f_high) {
+  if (plane >= _notches_by_plane.size()) {
+    std::cerr << "ERROR: FrequencyNoiseFilter: no plane " << plane
+              << ", call init first." << std::endl;
+    return;
+  }
+  frequency_range _range;
+  _range.low = std::min(f_low, f_high);
+  _range.high = std::max(f_low, f_high);
+  _notches_by_plane[plane].push_back(_range);
+  _mask_ticks = 0;
+}
+
+void FrequencyNoiseFilter::clear_notches(unsigned int plane) {
+  if (plane < _notches_by_plane.size()) {
+    _notches_by_plane[plane].clear();
+    _mask_ticks = 0;
+  }
+}
+
+void FrequencyNoiseFilter::set_low_frequency_cut(unsigned int plane, float f_cut) {
+  if (plane >= _low_frequency_cut_by_plane.size()) {
+    std::cerr << "ERROR: FrequencyNoiseFilter: no plane " << plane
+              << ", call init first." << std::endl;
+    return;
+  }
+  _low_frequency_cut_by_plane[plane] = f_cut;
+  _mask_ticks = 0;
+}
+
+void FrequencyNoiseFilter::prepare_masks(int _n_time_ticks_data) {
+
+  if (_mask_ticks == _n_time_ticks_data) {
+    return;
+  }
+
+  int n_bins = _n_time_ticks_data / 2 + 1;
+  // Width of a frequency bin, in MHz:
+  double bin_width = _sampling_frequency / _n_time_ticks_data;
+
+  _mask_by_plane.resize(_notches_by_plane.size());
+  for (size_t plane = 0; plane < _notches_by_plane.size(); plane ++) {
+    std::vector<float> & _mask = _mask_by_plane[plane];
+    _mask.assign(n_bins, 1.0);
+
+    for (int bin = 0; bin < n_bins; bin ++) {
+      double f = bin * bin_width;
+      if (f < _low_frequency_cut_by_plane[plane]) {
+        _mask[bin] = 0.0;
+      }
+      for (auto const & _notch : _notches_by_plane[plane]) {
+        // A bin is removed if any part of it is inside the notch
+        if (f + 0.5 * bin_width >= _notch.low && f - 0.5 * bin_width <= _notch.high) {
+          _mask[bin] = 0.0;
+        }
+      }
+    }
+  }
+
+  _mask_ticks = _n_time_ticks_data;
+}
+
+void FrequencyNoiseFilter::prepare_plans(int _n_time_ticks_data) {
+
+  if (_plan_ticks == _n_time_ticks_data && !_workspaces.empty()) {
+    return;
+  }
+
+  for (auto & _ws : _workspaces) {
+    delete _ws.forward;
+    delete _ws.backward;
+  }
+
+  // Plans are made once per waveform length.  "K" keeps each plan out of
+  // the global TVirtualFFT so every thread owns its own pair.  Making plans
+  // is not thread safe, executing distinct plans is.
+  int n = _n_time_ticks_data;
+  _workspaces.resize(_pool->n_threads());
+  for (auto & _ws : _workspaces) {
+    _ws.forward = TVirtualFFT::FFT(1, &n, "R2C M K");
+    _ws.backward = TVirtualFFT::FFT(1, &n, "C2R M K");
+    if (!_ws.forward || !_ws.backward) {
+      throw std::runtime_error("NoiseFilterException: Could not create the FFT plans.");
+    }
+    _ws.time.resize(n);
+    _ws.re.resize(n / 2 + 1);
+    _ws.im.resize(n / 2 + 1);
+  }
+
+  _plan_ticks = _n_time_ticks_data;
+}
+
+void FrequencyNoiseFilter::filter_wire(float * _wire_data,
+                                       int _n_time_ticks_data,
+                                       const std::vector<float> & _mask,
+                                       int thread)
+{
+  fft_workspace & _ws = _workspaces[thread];
+  int n_bins = _n_time_ticks_data / 2 + 1;
+
+  std::copy(_wire_data, _wire_data + _n_time_ticks_data, _ws.time.begin());
+  _ws.forward->SetPoints(&(_ws.time[0]));
+  _ws.forward->Transform();
+  _ws.forward->GetPointsComplex(&(_ws.re[0]), &(_ws.im[0]));
+
+  // The inverse transform is not normalized, fold 1/N into the mask:
+  double norm = 1.0 / _n_time_ticks_data;
+  for (int bin = 0; bin < n_bins; bin ++) {
+    _ws.re[bin] *= _mask[bin] * norm;
+    _ws.im[bin] *= _mask[bin] * norm;
+  }
+
+  _ws.backward->SetPointsComplex(&(_ws.re[0]), &(_ws.im[0]));
+  _ws.backward->Transform();
+  _ws.backward->GetPoints(&(_ws.time[0]));
+
+  std::copy(_ws.time.begin(), _ws.time.end(), _wire_data);
+}
+
+void FrequencyNoiseFilter::filter_plane(float * _plane_data,
+                                        unsigned int plane,
+                                        int _n_time_ticks_data,
+                                        const std::vector<wireStatus> & _wire_status)
+{
+  if (!_pool) {
+    throw std::runtime_error("NoiseFilterException: FrequencyNoiseFilter used before init.");
+  }
+
+  prepare_masks(_n_time_ticks_data);
+  prepare_plans(_n_time_ticks_data);
+
+  const std::vector<float> & _mask = _mask_by_plane.at(plane);
+
+  // Nothing to do if the mask keeps every frequency:
+  if (std::find(_mask.begin(), _mask.end(), 0.0) == _mask.end()) {
+    return;
+  }
+
+  int n_wires = _detector_properties_interface.n_wires(plane);
+  int n_batches = (n_wires + _wire_batch_size - 1) / _wire_batch_size;
+
+  _pool->run(n_batches, [&](int batch, int thread) {
+    int wire_end = std::min(n_wires, (batch + 1) * _wire_batch_size);
+    for (int wire = batch * _wire_batch_size; wire < wire_end; wire ++) {
+      if (_wire_status[wire] != kNormal) {
+        continue;
+      }
+      filter_wire(_plane_data + (size_t) wire * _n_time_ticks_data,
+                  _n_time_ticks_data, _mask, thread);
+    }
+  });
+}
+
+} // ub_noise_filter
+
+#endif
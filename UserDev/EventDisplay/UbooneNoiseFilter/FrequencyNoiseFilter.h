@@ -0,0 +1,162 @@
+/**
+ * \file FrequencyNoiseFilter.h
+ *
+ * \ingroup RawViewer
+ *
+ * \brief Class def header for a class FrequencyNoiseFilter
+ *
+ *  This class removes harmonic noise in the frequency domain.  Each wire is
+ *  transformed with a real FFT, multiplied by a per plane mask (notches at
+ *  the noise frequencies, optionally a low frequency cut) and transformed
+ *  back.  The FFT plans are made once per waveform length and reused; wires
+ *  are processed in batches on a thread pool, with one pair of plans and one
+ *  set of buffers per thread.
+ *
+ *  It is an alternative to the time domain harmonic noise estimate in
+ *  CorrelatedNoiseFilter, see UbooneNoiseFilter::set_frequency_filter.
+ *
+ * @author cadams
+ */
+
+/** \addtogroup RawViewer
+
+    @{*/
+#ifndef FREQUENCYNOISEFILTER_H
+#define FREQUENCYNOISEFILTER_H
+
+#include <iostream>
+#include <vector>
+
+#include "NoiseFilterTypes.h"
+#include "Base/threadpool.h"
+
+class TVirtualFFT;
+
+/**
+   \class FrequencyNoiseFilter
+   User defined class FrequencyNoiseFilter ... these comments are used to generate
+   doxygen documentation!
+ */
+
+namespace ub_noise_filter {
+
+class FrequencyNoiseFilter {
+
+public:
+
+  /// Default constructor
+  FrequencyNoiseFilter();
+
+  /// Default destructor
+  ~FrequencyNoiseFilter();
+
+  /**
+   * @brief Take the detector layout and start the thread pool
+   * @details Must be called before filter_plane.  The masks are kept, the
+   *          FFT plans are made on the first event.
+   *
+   * @param detector The layout, already initialized, it is copied
+   */
+  void init(const detPropFetcher & detector);
+
+  /**
+   * @brief Number of threads used, including the calling thread
+   * @details 0 means one per core.  Takes effect at the next init.
+   */
+  void set_n_threads(unsigned int _n) {_n_threads = _n;}
+
+  /**
+   * @brief Digitization frequency, in MHz.  Default is 2 MHz.
+   */
+  void set_sampling_frequency(float _f) {_sampling_frequency = _f; _mask_ticks = 0;}
+
+  /**
+   * @brief Remove the frequencies in [f_low, f_high] on this plane
+   *
+   * @param plane Plane number
+   * @param f_low Lower edge of the notch, in MHz
+   * @param f_high Upper edge of the notch, in MHz
+   */
+  void add_notch(unsigned int plane, float f_low, float f_high);
+
+  /**
+   * @brief Remove all the notches of this plane
+   */
+  void clear_notches(unsigned int plane);
+
+  /**
+   * @brief Remove the frequencies below f_cut on this plane (0 disables)
+   *
+   * @param plane Plane number
+   * @param f_cut Frequency in MHz
+   */
+  void set_low_frequency_cut(unsigned int plane, float f_cut);
+
+  /**
+   * @brief Filter every wire of a plane in place
+   * @details Wires that are dead, noisy or chirping are left untouched,
+   *          the later stages zero or truncate them anyway.
+   *
+   * @param _plane_data Array of data in the plane, wires concatenated
+   * @param plane Plane number
+   * @param _n_time_ticks_data Length of each wire in ticks
+   * @param _wire_status Status of each wire in the plane
+   */
+  void filter_plane(float * _plane_data,
+                    unsigned int plane,
+                    int _n_time_ticks_data,
+                    const std::vector<wireStatus> & _wire_status);
+
+  /// Gain of each frequency bin for this plane, for the last waveform length
+  const std::vector<float> & get_mask(unsigned int plane) const {return _mask_by_plane.at(plane);}
+
+private:
+
+  /// Make the FFT plans and buffers for this waveform length, if needed
+  void prepare_plans(int _n_time_ticks_data);
+
+  /// Make the frequency masks for this waveform length, if needed
+  void prepare_masks(int _n_time_ticks_data);
+
+  /// Transform, mask, and transform back one wire
+  void filter_wire(float * _wire_data, int _n_time_ticks_data, const std::vector<float> & _mask, int thread);
+
+  // Number of wires given to a thread at once
+  const int _wire_batch_size = 32;
+
+  unsigned int _n_threads;
+  float _sampling_frequency;
+
+  // Per plane configuration, in MHz
+  struct frequency_range {
+    float low;
+    float high;
+  };
+  std::vector<std::vector<frequency_range> > _notches_by_plane;
+  std::vector<float> _low_frequency_cut_by_plane;
+
+  // Per plane gain for each frequency bin, for _mask_ticks long waveforms
+  std::vector<std::vector<float> > _mask_by_plane;
+  int _mask_ticks;
+
+  // One set of plans and buffers per thread, for _plan_ticks long waveforms
+  struct fft_workspace {
+    TVirtualFFT * forward;
+    TVirtualFFT * backward;
+    std::vector<double> time;
+    std::vector<double> re;
+    std::vector<double> im;
+  };
+  std::vector<fft_workspace> _workspaces;
+  int _plan_ticks;
+
+  galleryfmwk::threadpool * _pool;
+
+  ub_noise_filter::detPropFetcher _detector_properties_interface;
+
+};
+
+} // ub_noise_filter
+
+#endif
+/** @} */ // end of doxygen group
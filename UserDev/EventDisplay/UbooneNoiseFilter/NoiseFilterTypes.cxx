@@ -1,6 +1,16 @@
 #ifndef NOISEFILTER_TYPES_CXX
 #define NOISEFILTER_TYPES_CXX
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "larcorealg/Geometry/GeometryCore.h"
+
 #include "NoiseFilterTypes.h"
 
 namespace ub_noise_filter {
@@ -155,283 +165,292 @@ float getMean(const std::vector<float> & _input) {
 
 
 
-void detPropFetcher::init(){
-  _wire_lengths.resize(3);
-  _wire_lengths[0].resize(2400);
-  _wire_lengths[1].resize(2400);
-  _wire_lengths[2].resize(3456);
+std::string board_map_filename(const std::string & detector_name) {
 
-  _wire_scales.resize(3);
-  _wire_scales[0].resize(2400);
-  _wire_scales[1].resize(2400);
-  _wire_scales[2].resize(3456);
+  std::string name(detector_name);
+  std::transform(name.begin(), name.end(), name.begin(), ::tolower);
 
-  auto geom = larutil::Geometria::GetME();
+  if (name.compare(0, 10, "microboone") == 0) {
+    return "microboone_board_map.txt";
+  }
+  return "";
+}
 
 
-  for (int wire = 0; wire < 2400; wire ++) {
-    double xyzStart[3];
-    double xyzEnd[3];
+void detPropFetcher::init(const geo::GeometryCore & geometry) {
 
+  std::string board_map_file;
 
-    geom ->WireEndPoints(0, wire,
-                         xyzStart,
-                         xyzEnd) ;
+  std::string file_name = board_map_filename(geometry.DetectorName());
+  const char * userdev_dir = getenv("GALLERY_FMWK_USERDEVDIR");
+  if (!file_name.empty() && userdev_dir) {
+    board_map_file = std::string(userdev_dir)
+                     + "/EventDisplay/UbooneNoiseFilter/dat/"
+                     + file_name;
+  }
 
-    _wire_lengths[0][wire] = sqrt(
-                               (xyzStart[0] - xyzEnd[0]) * (xyzStart[0] - xyzEnd[0]) +
-                               (xyzStart[1] - xyzEnd[1]) * (xyzStart[1] - xyzEnd[1]) +
-                               (xyzStart[2] - xyzEnd[2]) * (xyzStart[2] - xyzEnd[2])
-                             );
+  init(geometry, board_map_file);
+}
+
+void detPropFetcher::init(const geo::GeometryCore & geometry,
+                          const std::string & board_map_file) {
 
-    _wire_scales[0][wire] = _wire_lengths[0][wire] / 456.9;
+  load_geometry(geometry);
 
-    geom ->WireEndPoints(1, wire,
-                         xyzStart,
-                         xyzEnd) ;
+  if (_max_wire_length_by_plane.empty()) {
+    throw std::runtime_error("NoiseFilterException: the geometry has no wire planes.");
+  }
 
-    _wire_lengths[1][wire] = sqrt(
-                               (xyzStart[0] - xyzEnd[0]) * (xyzStart[0] - xyzEnd[0]) +
-                               (xyzStart[1] - xyzEnd[1]) * (xyzStart[1] - xyzEnd[1]) +
-                               (xyzStart[2] - xyzEnd[2]) * (xyzStart[2] - xyzEnd[2])
-                             );
+  _board_ranges.clear();
+  _noisy_wires_by_plane.clear();
+  _noisy_wires_by_plane.resize(n_planes());
 
-    _wire_scales[1][wire] = _wire_lengths[1][wire] / 456.9;
+  // Default reference: the longest wire in the detector
+  _reference_length = *std::max_element(_max_wire_length_by_plane.begin(),
+                                        _max_wire_length_by_plane.end());
 
+  if (board_map_file.empty() || !read_board_map(board_map_file)) {
+    std::cout << "detPropFetcher: no readout board map, using blocks of "
+              << kDefaultWiresPerBoard << " wires." << std::endl;
   }
 
-  for (int wire = 0; wire < 3456; wire ++) {
-    double xyzStart[3];
-    double xyzEnd[3];
+  for (unsigned int channel = 0; channel < n_channels(); channel ++) {
+    _wire_scale_by_channel[channel] = _wire_length_by_channel[channel] / _reference_length;
+  }
 
+  build_boards();
+}
 
-    geom ->WireEndPoints(2, wire,
-                         xyzStart,
-                         xyzEnd) ;
+void detPropFetcher::load_geometry(const geo::GeometryCore & geometry) {
 
-    _wire_lengths[2][wire] = sqrt(
-                               (xyzStart[0] - xyzEnd[0]) * (xyzStart[0] - xyzEnd[0]) +
-                               (xyzStart[1] - xyzEnd[1]) * (xyzStart[1] - xyzEnd[1]) +
-                               (xyzStart[2] - xyzEnd[2]) * (xyzStart[2] - xyzEnd[2])
-                             );
+  // The planes and wires of the first TPC, as they are laid out by the display
+  unsigned int n_planes = geometry.Nplanes();
+  unsigned int n_channels = geometry.Nchannels();
 
-    _wire_scales[2][wire] = _wire_lengths[2][wire] / 456.9;
+  _channel_by_plane_wire.clear();
+  _channel_by_plane_wire.resize(n_planes);
+  _max_wire_length_by_plane.assign(n_planes, 0.0);
 
-  }
+  _wire_length_by_channel.assign(n_channels, 0.0);
+  _wire_scale_by_channel.assign(n_channels, 0.0);
+  _block_by_channel.assign(n_channels, 0);
 
-}
+  for (unsigned int plane = 0; plane < n_planes; plane ++) {
 
-int detPropFetcher::same_plane_pair(int plane, int block){
-  // if (plane == 0 && block > 41){
-  //   return -1;
-  // }  
-  // if (plane == 1 && block < 14){
-  //   return -1;
-  // }
+    _channel_by_plane_wire[plane].resize(geometry.Nwires(plane));
 
-  if (block % 2 == 0){
-    return block + 1;
-  }
-  else{
-    return block -1;
-  }
-}
+    for (unsigned int wire = 0; wire < geometry.Nwires(plane); wire ++) {
+      geo::WireID wire_id(0, 0, plane, wire);
 
+      double xyzStart[3];
+      double xyzEnd[3];
 
+      geometry.WireEndPoints(wire_id,
+                             xyzStart,
+                             xyzEnd) ;
 
-std::vector<std::vector<float> > detPropFetcher::service_board_block(int plane, int block) {
+      unsigned int channel = geometry.PlaneWireToChannel(wire_id);
+      if (channel >= n_channels) {
+        throw std::runtime_error("NoiseFilterException: wire channel is outside the geometry's channels.");
+      }
+      _channel_by_plane_wire[plane][wire] = channel;
 
-  std::vector< std::vector<float> > ret;
+      _wire_length_by_channel[channel] = sqrt(
+                                           (xyzStart[0] - xyzEnd[0]) * (xyzStart[0] - xyzEnd[0]) +
+                                           (xyzStart[1] - xyzEnd[1]) * (xyzStart[1] - xyzEnd[1]) +
+                                           (xyzStart[2] - xyzEnd[2]) * (xyzStart[2] - xyzEnd[2])
+                                         );
 
-  ret.resize(3);
+      _max_wire_length_by_plane[plane] = std::max(_max_wire_length_by_plane[plane],
+                                                  _wire_length_by_channel[channel]);
+    }
+  }
 
-  int second_block;
+}
 
-  if (plane == 0) {
+bool detPropFetcher::read_board_map(const std::string & board_map_file) {
 
-    // Reject if block is too high:
-    if (block > 50) {
-      std::cerr << "Requested block is too high." << std::endl;
-      return ret;
-    }
+  std::ifstream map_file(board_map_file.c_str());
+  if (!map_file.is_open()) {
+    std::cerr << "ERROR: can't open readout board map " << board_map_file << std::endl;
+    return false;
+  }
 
-    // Catch the edge cases:
-    if (block > 35) {
-
-      if (block < 41) {
-        ret[0].push_back(36);
-        ret[0].push_back(37);
-        ret[0].push_back(38);
-        ret[0].push_back(39);
-        ret[0].push_back(40);
-        ret[0].push_back(41);
-        return ret;
-      }
-      else {
-        ret[0].push_back(42);
-        ret[0].push_back(43);
-        ret[0].push_back(44);
-        ret[0].push_back(45);
-        ret[0].push_back(46);
-        ret[0].push_back(47);
-        ret[0].push_back(48);
-        ret[0].push_back(49);
-        return ret;
-      }
+  std::string line;
+  int line_number = 0;
+  while (std::getline(map_file, line)) {
+    line_number ++;
 
+    // Strip comments
+    size_t comment = line.find('#');
+    if (comment != std::string::npos) {
+      line.erase(comment);
+    }
 
+    std::istringstream tokens(line);
+    std::string key;
+    if (!(tokens >> key)) {
+      continue;
     }
-    else {
 
-      // Figure out which pair of blocks this goes with in the same plane:
-      if (block % 2 == 0) {
-        second_block = block + 1;
+    bool good = false;
+    if (key == "reference_length") {
+      double length;
+      if (tokens >> length && length > 0) {
+        _reference_length = length;
+        good = true;
       }
-      else {
-        second_block = block - 1;
+    }
+    else if (key == "boards") {
+      board_range range;
+      if (tokens >> range.plane >> range.first_wire >> range.end_wire
+          >> range.wires_per_board >> range.first_service_board
+          >> range.boards_per_service_board
+          && range.plane < n_planes()
+          && range.wires_per_board > 0
+          && range.boards_per_service_board > 0) {
+        _board_ranges.push_back(range);
+        good = true;
       }
-
-      if (block > second_block) {
-        std::swap(block, second_block);
+    }
+    else if (key == "noisy") {
+      unsigned int plane, first_wire, end_wire;
+      if (tokens >> plane >> first_wire >> end_wire && plane < n_planes()) {
+        end_wire = std::min(end_wire, n_wires(plane));
+        _noisy_wires_by_plane[plane].push_back(std::make_pair(first_wire, end_wire));
+        good = true;
       }
+    }
 
-      // Now build up the vectors:
-      // This is plane 0, so that's easy:
-      ret[0].push_back(block);
-      ret[0].push_back(second_block);
-
-      // This is plane 0, so that's easy:
-      ret[1].push_back(block + 14);
-      ret[1].push_back(second_block + 14);
-
-      // This is plane 0, so that's easy:
-      ret[2].push_back(block);
-      ret[2].push_back(second_block);
-
+    if (!good) {
+      std::cerr << "ERROR: bad line " << line_number << " in readout board map "
+                << board_map_file << ": " << line << std::endl;
     }
+  }
+
+  return true;
+}
 
+void detPropFetcher::build_boards() {
+
+  _correlated_noise_blocks.clear();
+  _correlated_noise_blocks.resize(n_planes());
+  _service_board_by_block.clear();
+  _service_board_by_block.resize(n_planes());
+
+  // Wires without a board from the map get their own service boards,
+  // numbered after the ones used in the map.
+  int next_service_board = 0;
+  for (auto const & range : _board_ranges) {
+    int n_boards = (range.end_wire < 0 ? n_wires(range.plane) : range.end_wire) - range.first_wire;
+    n_boards = (n_boards + range.wires_per_board - 1) / range.wires_per_board;
+    int last = range.first_service_board + (n_boards - 1) / range.boards_per_service_board;
+    next_service_board = std::max(next_service_board, last + 1);
   }
-  else if (plane == 1) {
 
-    // Reject if block is too high:
-    if (block > 50) {
-      std::cerr << "Requested block is too high." << std::endl;
-      return ret;
+  for (unsigned int plane = 0; plane < n_planes(); plane ++) {
+
+    // The board lines for this plane, in wire order
+    std::vector<board_range> ranges;
+    for (auto const & range : _board_ranges) {
+      if (range.plane == plane) {
+        ranges.push_back(range);
+      }
     }
+    std::sort(ranges.begin(), ranges.end(),
+    [](const board_range & a, const board_range & b) {return a.first_wire < b.first_wire;});
 
+    std::vector<float> & boundaries = _correlated_noise_blocks[plane];
+    std::vector<int> & service_boards = _service_board_by_block[plane];
 
-    if (block < 14) {
-      if (block < 8) {
-        ret[1].push_back(0);
-        ret[1].push_back(1);
-        ret[1].push_back(2);
-        ret[1].push_back(3);
-        ret[1].push_back(4);
-        ret[1].push_back(5);
-        ret[1].push_back(6);
-        ret[1].push_back(7);
-        return ret;
-      }
-      else {
-        ret[1].push_back(8);
-        ret[1].push_back(9);
-        ret[1].push_back(10);
-        ret[1].push_back(11);
-        ret[1].push_back(12);
-        ret[1].push_back(13);
-        return ret;
+    unsigned int wire = 0;
+    size_t i_range = 0;
+    while (wire < n_wires(plane)) {
+
+      // Skip lines that are already covered:
+      while (i_range < ranges.size() &&
+             ranges[i_range].end_wire >= 0 &&
+             (unsigned int) ranges[i_range].end_wire <= wire) {
+        i_range ++;
       }
-    }
-    else {
 
-      // Figure out which pair of blocks this goes with in the same plane:
-      if (block % 2 == 0) {
-        second_block = block + 1;
+      boundaries.push_back(wire);
+
+      if (i_range < ranges.size() && ranges[i_range].first_wire <= wire) {
+        const board_range & range = ranges[i_range];
+        unsigned int end = (range.end_wire < 0) ? n_wires(plane) : range.end_wire;
+        unsigned int board = (wire - range.first_wire) / range.wires_per_board;
+        service_boards.push_back(range.first_service_board
+                                 + board / range.boards_per_service_board);
+        wire = std::min(std::min(end, n_wires(plane)),
+                        range.first_wire + (board + 1) * range.wires_per_board);
       }
       else {
-        second_block = block - 1;
+        unsigned int end = n_wires(plane);
+        if (i_range < ranges.size()) {
+          end = std::min(end, ranges[i_range].first_wire);
+        }
+        service_boards.push_back(next_service_board ++);
+        wire = std::min(end, wire + kDefaultWiresPerBoard);
       }
+    }
+    boundaries.push_back(n_wires(plane));
 
-      if (block > second_block) {
-        std::swap(block, second_block);
+    // Fill the flat block lookup:
+    for (size_t i_block = 0; i_block + 1 < boundaries.size(); i_block ++) {
+      for (unsigned int w = boundaries[i_block]; w < boundaries[i_block + 1]; w ++) {
+        _block_by_channel[channel(plane, w)] = i_block;
       }
+    }
+  }
 
-      // Now build up the vectors:
-      // This is plane 0, so that's easy:
-      ret[0].push_back(block - 14);
-      ret[0].push_back(second_block - 14);
-
-      // This is plane 0, so that's easy:
-      ret[1].push_back(block);
-      ret[1].push_back(second_block);
+}
 
-      // This is plane 0, so that's easy:
-      ret[2].push_back(block - 14);
-      ret[2].push_back(second_block - 14);
-    }
+int detPropFetcher::same_plane_pair(int plane, int block) const {
 
+  // Boards are paired with their neighbor if it is on the same service board:
+  int pair = (block % 2 == 0) ? block + 1 : block - 1;
 
+  const std::vector<int> & service_boards = _service_board_by_block.at(plane);
+  if (block < 0 || block >= (int) service_boards.size()) {
+    return block;
+  }
+  if (pair < 0 || pair >= (int) service_boards.size()) {
+    return block;
+  }
+  if (service_boards[pair] != service_boards[block]) {
+    return block;
   }
-  else if (plane == 2) {
+  return pair;
+}
 
-    // Reject if block is too high:
-    if (block > 36) {
-      std::cerr << "Requested block is too high." << std::endl;
-      return ret;
-    }
 
-    // Figure out which pair of blocks this goes with in the same plane:
-    if (block % 2 == 0) {
-      second_block = block + 1;
-    }
-    else {
-      second_block = block - 1;
-    }
 
-    if (block > second_block) {
-      std::swap(block, second_block);
-    }
+std::vector<std::vector<float> > detPropFetcher::service_board_block(int plane, int block) const {
 
-    // Now build up the vectors:
-    // This is plane 0, so that's easy:
-    ret[0].push_back(block);
-    ret[0].push_back(second_block);
+  std::vector< std::vector<float> > ret;
 
-    // This is plane 0, so that's easy:
-    ret[1].push_back(block + 14);
-    ret[1].push_back(second_block + 14);
+  ret.resize(n_planes());
 
-    // This is plane 0, so that's easy:
-    ret[2].push_back(block);
-    ret[2].push_back(second_block);
+  if (plane < 0 || plane >= (int) n_planes() ||
+      block < 0 || block >= (int) _service_board_by_block[plane].size()) {
+    std::cerr << "Requested block is too high." << std::endl;
+    return ret;
+  }
 
+  int service_board = _service_board_by_block[plane][block];
 
+  for (size_t i_plane = 0; i_plane < n_planes(); i_plane ++) {
+    for (size_t i_block = 0; i_block < _service_board_by_block[i_plane].size(); i_block ++) {
+      if (_service_board_by_block[i_plane][i_block] == service_board) {
+        ret[i_plane].push_back(i_block);
+      }
+    }
   }
 
-
   return ret;
 }
 
-unsigned int detPropFetcher::n_wires(unsigned int plane) {
-  if (plane == 0)
-    return 2400;
-  else if (plane == 1)
-    return 2400;
-  else
-    return 3456;
-}
-unsigned int detPropFetcher::n_planes() {
-  return 3;
-}
-
-double detPropFetcher::wire_length(unsigned int plane, unsigned int wire) {
-  return _wire_lengths[plane][wire];
-}
-
-double detPropFetcher::wire_scale(unsigned int plane, unsigned int wire) {
-  return _wire_scales[plane][wire];
-}
-
 
 }
 
@@ -1,7 +1,12 @@
 #ifndef NOISEFILTER_TYPES_H
 #define NOISEFILTER_TYPES_H
 
-#include "LArUtil/Geometria.h"
+#include <string>
+#include <vector>
+
+namespace geo {
+class GeometryCore;
+}
 
 
 namespace ub_noise_filter {
@@ -66,11 +71,35 @@ float getCorrelation(const std::vector<float> & _input1, const std::vector<float
 float getCorrelation(const float * _input1, const float * _input2, unsigned int N);
 
 
+/**
+ * @brief Readout board map file for a detector
+ * @details Files live in $GALLERY_FMWK_USERDEVDIR/EventDisplay/UbooneNoiseFilter/dat/
+ *          and are chosen by the start of the geometry's detector name.
+ *          An empty name means the default grouping (see detPropFetcher) is used.
+ *
+ * @param detector_name Detector name, as in geo::GeometryCore::DetectorName
+ * @return The file name, without its directory
+ */
+std::string board_map_filename(const std::string & detector_name);
+
 /**
  * @brief Detector Properties interface for the noise filter
- * @details In the entire noise filter framework, this is really the only 
- *          framework (larlite, etc.) dependent class.  This is needed
- *          to get the length of wires, which is important in harmonic noise calculations.
+ * @details In the entire noise filter framework, this is really the only
+ *          framework (larsoft, etc.) dependent class.  The plane and wire
+ *          layout and the wire lengths come from the geo::GeometryCore the
+ *          display uses (the planes of the first TPC), and the
+ *          grouping of wires into readout (mother) boards and service boards
+ *          comes from a small text file:
+ *
+ *          # comment
+ *          reference_length <cm>    harmonic noise is scaled by wire length / this
+ *          boards <plane> <first wire> <end wire, or -1 for the end of the plane>
+ *                 <wires per board> <first service board> <boards per service board>
+ *          noisy <plane> <first wire> <end wire>    wires always treated as noisy
+ *
+ *          Wires not covered by any board line are grouped in boards of
+ *          kDefaultWiresPerBoard wires, each on its own service board.
+ *          Per wire quantities are stored in flat arrays indexed by channel.
  */
 class detPropFetcher {
 
@@ -78,20 +107,44 @@ public:
 
   detPropFetcher(){}
 
-  void init();
+  /// Load the layout of the geometry, and the board map for its detector
+  void init(const geo::GeometryCore & geometry);
 
-  unsigned int n_wires(unsigned int plane);
-  unsigned int n_planes();
-  double wire_length(unsigned int plane, unsigned int wire);
-  double wire_scale(unsigned int plane, unsigned int wire);
+  /// Load the layout of the geometry, and the board map from the given file
+  void init(const geo::GeometryCore & geometry, const std::string & board_map_file);
+
+  unsigned int n_wires(unsigned int plane) const {return _channel_by_plane_wire.at(plane).size();}
+  unsigned int n_planes() const {return _channel_by_plane_wire.size();}
+  unsigned int n_channels() const {return _wire_length_by_channel.size();}
+
+  unsigned int channel(unsigned int plane, unsigned int wire) const {
+    return _channel_by_plane_wire[plane][wire];
+  }
+
+  double wire_length(unsigned int plane, unsigned int wire) const {
+    return _wire_length_by_channel[channel(plane, wire)];
+  }
+  double wire_scale(unsigned int plane, unsigned int wire) const {
+    return _wire_scale_by_channel[channel(plane, wire)];
+  }
+
+  /// True if this wire is (within rounding) as long as the longest wire in its plane
+  bool is_full_length(unsigned int plane, unsigned int wire) const {
+    return wire_length(plane, wire) >= _max_wire_length_by_plane[plane] - 0.5;
+  }
+
+  /// Index, within its plane, of the board block this wire belongs to
+  int block(unsigned int plane, unsigned int wire) const {
+    return _block_by_channel[channel(plane, wire)];
+  }
 
   /**
    * @brief Get the start and end wires of mother board blocks on each plane
    * @details Vector of start and end wires for each motherboard block is returned.
    *          In general, use these boundaries in the typical c++ way:  for block i,
    *          use a loop over wires from result[i] to < result[i+1]
-   * 
-   * @param plane Plane 0, 1, or 2
+   *
+   * @param plane Plane number
    */
   const std::vector<float> & correlated_noise_blocks(int plane) const {
     return _correlated_noise_blocks.at(plane);
@@ -100,65 +153,70 @@ public:
   /**
    * @brief return the motherboard on the same service board in this plane
    * @details Gives the mother board that should be most highly correlated
-   *          to the input motherboard
-   * 
-   * @param plane 0, 1, or 2
+   *          to the input motherboard.  If there is none, returns the input block.
+   *
+   * @param plane Plane number
    * @param block Motherboard (or index of block of wires)
-   * 
+   *
    * @return The same-service-board motherboard (or index of block of wires)
    */
-  int same_plane_pair(int plane, int block);
+  int same_plane_pair(int plane, int block) const;
 
   /**
    * @brief Get the list of (plane, block) within a service board
-   * @details Returns a vector of vector of ints, size 3xN.  Input a plane and block
+   * @details Returns a vector of vector of ints, size n_planes x N.  Input a plane and block
    *          and the return will have all the motherboard blocks on the same service board.
-   *          Generally this is 3x2, but the vertical motherboards in uboone are unique.
-   * 
-   * @param plane 0, 1 or 2
+   *
+   * @param plane Plane number
    * @param block Motherboard (or index of block of wires)
-   * 
+   *
    * @return vector of correlated motherboards to input
    */
-  std::vector<std::vector<float> > service_board_block(int plane, int block);
+  std::vector<std::vector<float> > service_board_block(int plane, int block) const;
+
+  /// Ranges of wires, [first, end), that are always treated as noisy
+  const std::vector<std::pair<unsigned int, unsigned int> > & noisy_wires(unsigned int plane) const {
+    return _noisy_wires_by_plane.at(plane);
+  }
+
+  /// Board size used for wires not described by the board map
+  static const unsigned int kDefaultWiresPerBoard = 64;
 
 private:
 
+  void load_geometry(const geo::GeometryCore & geometry);
+
+  bool read_board_map(const std::string & board_map_file);
+
+  void build_boards();
+
   // The function for wire lengths is called A LOT
   // and so the values of the function are cached
   // (To avoid calls to sqrt)
-  std::vector<std::vector<double> > _wire_lengths;
-  std::vector<std::vector<double> > _wire_scales;
-
-  // This defines what blocks to use for correlated noise removal.
-  // It's every 48 wires in induction, 96 in collection
-  // That corresponds to motherboards in the TPC
-  const std::vector<std::vector<float> > _correlated_noise_blocks = {
-    {
-      0, 48, 96, 144, 192, 240, 288, 336, 384, 432, 480,
-      528, 576, 624, 672, 720, 768, 816, 864, 912, 960,
-      1008, 1056, 1104, 1152, 1200, 1248, 1296, 1344, 1392,
-      1440, 1488, 1536, 1584, 1632, 1680, 1728, 1776, 1824,
-      1872, 1920, 1968, 2016, 2064, 2112, 2160, 2208,
-      2256, 2304, 2352, 2400
-    },
-    {
-      0, 48, 96, 144, 192, 240, 288, 336, 384, 432, 480,
-      528, 576, 624, 672, 720, 768, 816, 864, 912, 960,
-      1008, 1056, 1104, 1152, 1200, 1248, 1296, 1344, 1392, 
-      1440, 1488, 1536, 1584, 1632, 1680, 1728, 1776, 1824, 
-      1872, 1920, 1968, 2016, 2064, 2112, 2160, 2208,
-      2256, 2304, 2352, 2400
-    },
-    {
-      0, 96, 192, 288, 384, 480, 576, 672, 768, 864, 960, 
-      1056, 1152, 1248, 1344, 1440, 1536, 1632, 1728, 1824,
-      1920, 2016, 2112, 2208, 2304, 2400, 2496, 2592, 2688,
-      2784, 2880, 2976, 3072, 3168, 3264, 3360, 3456
-    }
+  std::vector<double> _wire_length_by_channel;
+  std::vector<double> _wire_scale_by_channel;
+  std::vector<int> _block_by_channel;
+  std::vector<std::vector<unsigned int> > _channel_by_plane_wire;
+  std::vector<double> _max_wire_length_by_plane;
+  double _reference_length;
+
+  // Board lines from the map file, before they are expanded to blocks
+  struct board_range {
+    unsigned int plane;
+    unsigned int first_wire;
+    int end_wire;
+    unsigned int wires_per_board;
+    int first_service_board;
+    unsigned int boards_per_service_board;
   };
+  std::vector<board_range> _board_ranges;
 
+  // This defines what blocks to use for correlated noise removal.
+  // That corresponds to motherboards in the TPC.
+  std::vector<std::vector<float> > _correlated_noise_blocks;
+  std::vector<std::vector<int> > _service_board_by_block;
 
+  std::vector<std::vector<std::pair<unsigned int, unsigned int> > > _noisy_wires_by_plane;
 
 };
 
@@ -166,13 +224,29 @@ private:
 //Used in classifying which wires are behaving in different ways
 enum wireStatus {kNormal, kDead, kHighNoise, kChirping, kNStatus};
 
+// Stages of UbooneNoiseFilter::clean_data, for timing
+enum filterStage {kChirpStage, kPedestalStage, kFrequencyStage,
+                  kCorrelatedStage, kSubtractionStage, kNStages};
+
+const std::string kSTAGE_NAME[kNStages] =
+{ "chirp",
+  "pedestal",
+  "frequency",
+  "correlated",
+  "subtraction"
+};
+
 // Used to keep track of when chirping starts and stops on a wire
+// Stored densely, one per wire, so that lookups are a plain index and not a map search.
 class chirp_info {
 
 public:
+  chirp_info() : chirp_start(0), chirp_stop(0), chirp_frac(0.0), chirping(false) {}
+
   size_t chirp_start;
   size_t chirp_stop;
   float chirp_frac;
+  bool chirping;
 };
 
 }
@@ -2,13 +2,16 @@
 #define UBOONENOISEFILTER_CXX
 
 #include "UbooneNoiseFilter.h"
+#include "Base/messenger.h"
+#include "TString.h"
 
 
 namespace ub_noise_filter {
 
-void UbooneNoiseFilter::init(){
+void UbooneNoiseFilter::init(const geo::GeometryCore & geometry){
 
-  _detector_properties_interface.init();
+  _detector_properties_interface.init(geometry);
+  _corr_filter.init(_detector_properties_interface);
 
   _pedestal_by_plane.resize(_detector_properties_interface.n_planes());
   _rms_by_plane.resize(_detector_properties_interface.n_planes());
@@ -19,7 +22,10 @@ void UbooneNoiseFilter::init(){
     _pedestal_by_plane.at(plane).resize(_detector_properties_interface.n_wires(plane));
     _rms_by_plane.at(plane).resize(_detector_properties_interface.n_wires(plane));
     _wire_status_by_plane.at(plane).resize(_detector_properties_interface.n_wires(plane));
+    _chirp_info_by_plane.at(plane).resize(_detector_properties_interface.n_wires(plane));
   }
+
+  reset_pedestal_tracking();
 }
 
 void UbooneNoiseFilter::set_data(std::vector<std::vector<float> > * _input_data) {
@@ -27,9 +33,19 @@ void UbooneNoiseFilter::set_data(std::vector<std::vector<float> > * _input_data)
   if (!_input_data) {
     throw std::runtime_error("NoiseFilterException: Bad pointer to data set provided.");
   }
-  else {
-    _data_by_plane = _input_data;
+
+  // The data layout has to match the detector layout the filter was set up with:
+  if (_input_data->size() != _detector_properties_interface.n_planes()) {
+    throw std::runtime_error("NoiseFilterException: Data has the wrong number of planes.");
   }
+  for (unsigned int plane = 0; plane < _detector_properties_interface.n_planes(); plane ++) {
+    if (_input_data->at(plane).size() !=
+        (size_t) _detector_properties_interface.n_wires(plane) * _n_time_ticks_data) {
+      throw std::runtime_error("NoiseFilterException: Data size does not match the number of wires and ticks.");
+    }
+  }
+
+  _data_by_plane = _input_data;
 
 }
 
@@ -58,13 +74,19 @@ void UbooneNoiseFilter::reset_internal_data() {
   }
 
 
-  // Clear the chirping data, but since it's a map
-  // and it's sparse delete the past data.
-  for (auto & _chirp_map : _chirp_info_by_plane) {
-    _chirp_map.clear();
+  // Clear the chirping data:
+  for (auto & _chirp_plane : _chirp_info_by_plane) {
+    for (auto & _chirp : _chirp_plane) {
+      _chirp = chirp_info();
+    }
   }
 
 
+  _n_pedestals_skipped = 0;
+  _n_pedestals_computed = 0;
+
+  _stage_times.assign(kNStages, 0.0);
+
   _corr_filter.reset();
 
 
@@ -72,9 +94,29 @@ void UbooneNoiseFilter::reset_internal_data() {
 }
 
 void UbooneNoiseFilter::set_n_time_ticks(unsigned int _n_time_ticks) {
+  // Tracked pedestals are only valid for the same readout window
+  if (_track_pedestals && _n_time_ticks != this->_n_time_ticks_data) {
+    reset_pedestal_tracking();
+  }
   this->_n_time_ticks_data = _n_time_ticks;
 }
 
+void UbooneNoiseFilter::set_frequency_filter(bool _use, unsigned int _n_threads) {
+
+  _use_frequency_filter = _use;
+  _corr_filter.set_harmonic_noise_removal(!_use);
+
+  if (_use) {
+    _freq_filter.set_n_threads(_n_threads);
+    _freq_filter.init(_detector_properties_interface);
+    for (unsigned int plane = 0; plane < _detector_properties_interface.n_planes(); plane ++) {
+      _freq_filter.clear_notches(plane);
+      _freq_filter.add_notch(plane, 0.035, 0.037);
+      _freq_filter.add_notch(plane, 0.107, 0.109);
+    }
+  }
+}
+
 void UbooneNoiseFilter::pedestal_subtract_only(){
   reset_internal_data();
   tag_special_wire_statuses();
@@ -82,21 +124,20 @@ void UbooneNoiseFilter::pedestal_subtract_only(){
 
   for (unsigned int plane = 0; plane < _detector_properties_interface.n_planes(); plane ++) {
 
+    // Very first step:  determine which wires are chirping.
+    auto _start = std::chrono::steady_clock::now();
+    find_chirping_wires(plane);
+    _start = add_stage_time(kChirpStage, _start);
+
     // Loop over the wires within the plane
     for (unsigned int wire = 0; wire < _detector_properties_interface.n_wires(plane); wire ++) {
 
 
       size_t offset = wire * _n_time_ticks_data;
 
-      // Very first step:  determine if this wire is chirping.
-
       // The wire in question is from _data_by_plane[plane][offset]
       // to _data_by_plane[plane][offset + _n_time_ticks_data]
       float * _wire_arr = &(_data_by_plane->at(plane).at(offset));
-      bool wire_is_chirping = is_chirping(_wire_arr,
-                                          _n_time_ticks_data,
-                                          wire,
-                                          plane);
 
       // if (wire_is_chirping && plane == 1 ) {
       //   if (_chirp_info_by_plane[plane][wire].chirp_frac != 1.0) {
@@ -121,8 +162,10 @@ void UbooneNoiseFilter::pedestal_subtract_only(){
       // rescale_by_rms(_wire_arr, _n_time_ticks_data, wire, plane);
 
     }
+    add_stage_time(kPedestalStage, _start);
   }
 
+  report_pedestal_tracking();
 
 }
 
@@ -138,21 +181,20 @@ void UbooneNoiseFilter::clean_data() {
   // First, do pedestal subtraction and determine if the wire is chirping:
   for (unsigned int plane = 0; plane < _detector_properties_interface.n_planes(); plane ++) {
 
+    // Very first step:  determine which wires are chirping.
+    auto _start = std::chrono::steady_clock::now();
+    find_chirping_wires(plane);
+    _start = add_stage_time(kChirpStage, _start);
+
     // Loop over the wires within the plane
     for (unsigned int wire = 0; wire < _detector_properties_interface.n_wires(plane); wire ++) {
 
 
       size_t offset = wire * _n_time_ticks_data;
 
-      // Very first step:  determine if this wire is chirping.
-
       // The wire in question is from _data_by_plane[plane][offset]
       // to _data_by_plane[plane][offset + _n_time_ticks_data]
       float * _wire_arr = &(_data_by_plane->at(plane).at(offset));
-      /*bool wire_is_chirping =*/ is_chirping(_wire_arr,
-                                          _n_time_ticks_data,
-                                          wire,
-                                          plane);
 
       // if (wire_is_chirping && plane == 1 ) {
       //   if (_chirp_info_by_plane[plane][wire].chirp_frac != 1.0) {
@@ -177,8 +219,25 @@ void UbooneNoiseFilter::clean_data() {
       // rescale_by_rms(_wire_arr, _n_time_ticks_data, wire, plane);
 
     }
+    add_stage_time(kPedestalStage, _start);
   }
 
+  report_pedestal_tracking();
+
+  // Remove the harmonic noise in the frequency domain, if requested.  Chirping
+  // regions are already zeroed and their status set, so they are skipped:
+  auto _start = std::chrono::steady_clock::now();
+  if (_use_frequency_filter) {
+    for (unsigned int plane = 0; plane < _detector_properties_interface.n_planes(); plane ++) {
+      _freq_filter.filter_plane(&(_data_by_plane->at(plane).front()),
+                                plane,
+                                _n_time_ticks_data,
+                                _wire_status_by_plane[plane]);
+    }
+  }
+
+  _start = add_stage_time(kFrequencyStage, _start);
+
   // Pass the chirping info and the wire status info to the correlated
   // noise filter
   _corr_filter.set_wire_status_pointer(&(_wire_status_by_plane) );
@@ -201,6 +260,8 @@ void UbooneNoiseFilter::clean_data() {
 
   // _corr_filter.fix_correlated_noise_errors();
 
+  _start = add_stage_time(kCorrelatedStage, _start);
+
 
   // Now clean up the wires from the correlated noise:
   for (unsigned int plane = 0; plane < _detector_properties_interface.n_planes(); plane ++) {
@@ -219,6 +280,8 @@ void UbooneNoiseFilter::clean_data() {
     }
   }
 
+  add_stage_time(kSubtractionStage, _start);
+
   // // Print out a few values just for debugging:
   // int plane = 2;
   // for (int wire = 287; wire < 310; wire ++) {
@@ -250,16 +313,17 @@ void UbooneNoiseFilter::get_pedestal_info(float * _data_arr, int N, int wire, in
   int end_tick = N;
 
 
-  if (_chirp_info_by_plane[plane].find(wire) != _chirp_info_by_plane[plane].end()) {
+  const chirp_info & _chirp = _chirp_info_by_plane[plane][wire];
+  if (_chirp.chirping) {
     // this wire IS chirping, so only use the good range:
     // Either start or the end of the wire will be one range of the chirping.
-    if (_chirp_info_by_plane[plane][wire].chirp_start == 0) {
-      start_tick = _chirp_info_by_plane[plane][wire].chirp_stop;
+    if (_chirp.chirp_start == 0) {
+      start_tick = _chirp.chirp_stop;
       end_tick = _n_time_ticks_data;
     }
     else {
       start_tick = 0.0;
-      end_tick = _chirp_info_by_plane[plane][wire].chirp_start;
+      end_tick = _chirp.chirp_start;
     }
   }
   else {
@@ -282,13 +346,30 @@ void UbooneNoiseFilter::get_pedestal_info(float * _data_arr, int N, int wire, in
   }
 
 
+  // In tracking mode, a wire that had a good pedestal last event only needs
+  // a quick check.  If the quick estimate agrees with the tracked value,
+  // the tracked pedestal is updated and the full calculation is skipped.
+  bool _pedestal_is_tracked = false;
+  if (_track_pedestals && _pedestal_tracked_by_plane[plane][wire]) {
+
+    float & _tracked_ped = _tracked_pedestal_by_plane[plane][wire];
+    float quick_ped = get_quick_pedestal(_data_arr, start_tick, end_tick);
+
+    if (fabs(quick_ped - _tracked_ped) < _pedestal_tolerance) {
+      _tracked_ped += _pedestal_tracking_weight * (quick_ped - _tracked_ped);
+      _pedestal_by_plane[plane][wire] = _tracked_ped;
+      _pedestal_is_tracked = true;
+      _n_pedestals_skipped ++;
+    }
+  }
+
   // Loop over the n ranges and sample evenly within each range to
   // accumulate a list of medians
 
   std::vector<float> median_list;
 
 
-  for (int i = 0; i < n_ranges; i ++) {
+  for (int i = 0; i < n_ranges && !_pedestal_is_tracked; i ++) {
     std::vector<float> _median_accumulator;
     _median_accumulator.reserve(min_submedian_n);
     int step_size = min_subrange_n / min_submedian_n;
@@ -307,7 +388,10 @@ void UbooneNoiseFilter::get_pedestal_info(float * _data_arr, int N, int wire, in
   }
 
   // Now, take the mean of the medians as the pedestal:
-  _pedestal_by_plane[plane][wire] = std::accumulate(median_list.begin(), median_list.end(), 0.0) / (float) n_ranges;
+  if (!_pedestal_is_tracked) {
+    _pedestal_by_plane[plane][wire] = std::accumulate(median_list.begin(), median_list.end(), 0.0) / (float) n_ranges;
+    _n_pedestals_computed ++;
+  }
 
 
   // Now, go through and do the pedestal subtraction.
@@ -358,12 +442,86 @@ void UbooneNoiseFilter::get_pedestal_info(float * _data_arr, int N, int wire, in
     }
   }
 
+  // Seed the tracker for the next event.  The rms is still measured every
+  // event (it comes for free with the subtraction) so that the dead and
+  // noisy cuts see the current event.  Only wires that pass those cuts
+  // are tracked, everything else gets a full calculation next time.
+  if (_track_pedestals) {
+    if (_wire_status_by_plane[plane][wire] == kDead ||
+        _wire_status_by_plane[plane][wire] == kHighNoise) {
+      _pedestal_tracked_by_plane[plane][wire] = false;
+    }
+    else if (!_pedestal_is_tracked) {
+      _tracked_pedestal_by_plane[plane][wire] = _pedestal_by_plane[plane][wire];
+      _pedestal_tracked_by_plane[plane][wire] = true;
+    }
+  }
+
+
+
+
+
+}
+
+
+float UbooneNoiseFilter::get_quick_pedestal(const float * _data_arr, int start_tick, int end_tick) {
+
+  int n_samples = 51; ///KEEP THIS NUMBER ODD!
+  int step_size = std::max(1, (end_tick - start_tick) / n_samples);
+
+  _quick_pedestal_samples.clear();
+  for (int tick = start_tick; tick < end_tick; tick += step_size) {
+    _quick_pedestal_samples.push_back(_data_arr[tick]);
+  }
+
+  return getMedian(_quick_pedestal_samples);
+}
 
+void UbooneNoiseFilter::set_pedestal_tracking(bool _do_tracking,
+                                              float _tolerance,
+                                              float _weight) {
+  _track_pedestals = _do_tracking;
+  _pedestal_tolerance = _tolerance;
+  _pedestal_tracking_weight = _weight;
+  reset_pedestal_tracking();
+}
 
+void UbooneNoiseFilter::reset_pedestal_tracking() {
+  _tracked_pedestal_by_plane.resize(_pedestal_by_plane.size());
+  _pedestal_tracked_by_plane.resize(_pedestal_by_plane.size());
+  for (size_t plane = 0; plane < _pedestal_by_plane.size(); plane ++) {
+    _tracked_pedestal_by_plane[plane].assign(_pedestal_by_plane[plane].size(), 0.0);
+    _pedestal_tracked_by_plane[plane].assign(_pedestal_by_plane[plane].size(), false);
+  }
+}
 
+std::chrono::steady_clock::time_point
+UbooneNoiseFilter::add_stage_time(filterStage stage,
+                                  const std::chrono::steady_clock::time_point & _start)
+{
+  auto _now = std::chrono::steady_clock::now();
+  _stage_times[stage] += std::chrono::duration<double>(_now - _start).count();
+  return _now;
+}
 
+float UbooneNoiseFilter::get_pedestal_skip_rate() const {
+  unsigned int total = _n_pedestals_skipped + _n_pedestals_computed;
+  if (total == 0) {
+    return 0.0;
+  }
+  return (float) _n_pedestals_skipped / (float) total;
 }
 
+void UbooneNoiseFilter::report_pedestal_tracking() const {
+  if (!_track_pedestals) {
+    return;
+  }
+  GALLERY_FMWK_MSG(galleryfmwk::msg::kINFO, __FUNCTION__,
+                   Form("Pedestal tracking skipped %u of %u wires (skip rate %g)",
+                        _n_pedestals_skipped,
+                        _n_pedestals_skipped + _n_pedestals_computed,
+                        get_pedestal_skip_rate()));
+}
 
 void UbooneNoiseFilter::apply_moving_average(
   float * _data_arr,
@@ -381,16 +539,17 @@ void UbooneNoiseFilter::apply_moving_average(
   int end_tick = N;
 
 
-  if (_chirp_info_by_plane[plane].find(wire) != _chirp_info_by_plane[plane].end()) {
+  const chirp_info & _chirp = _chirp_info_by_plane[plane][wire];
+  if (_chirp.chirping) {
     // this wire IS chirping, so only use the good range:
     // Either start or the end of the wire will be one range of the chirping.
-    if (_chirp_info_by_plane[plane][wire].chirp_start == 0) {
-      start_tick = _chirp_info_by_plane[plane][wire].chirp_stop;
+    if (_chirp.chirp_start == 0) {
+      start_tick = _chirp.chirp_stop;
       end_tick = _n_time_ticks_data;
     }
     else {
       start_tick = 0.0;
-      end_tick = _chirp_info_by_plane[plane][wire].chirp_start;
+      end_tick = _chirp.chirp_start;
     }
   }
   else {
@@ -398,14 +557,11 @@ void UbooneNoiseFilter::apply_moving_average(
 
   }
 
-  // Each bin is replaced by the average of it and the next bin;
+  // Each bin is replaced by the average of it and the next bins;
   // Default is 2 bins to remove zig zag noise.
 
-  for (int tick = start_tick; tick < end_tick - 1 ; tick ++) {
-
-    _data_arr[tick] = 0.5 * (_data_arr[tick] + _data_arr[tick + 1]);
-
-  }
+  moving_average(_data_arr, start_tick, end_tick,
+                 _moving_average_window, _moving_average_scratch);
 
 
 }
@@ -414,50 +570,54 @@ void UbooneNoiseFilter::apply_moving_average(
 
 
 
-bool UbooneNoiseFilter::is_chirping(float * _data_arr,
-                                    int N,
-                                    unsigned int wire,
-                                    unsigned int plane) {
+int UbooneNoiseFilter::find_chirping_wires(unsigned int plane) {
   // Run through the chirp filter stuff here.
   //
+  // This function comes first, and determines which waveforms are chirping.
+  // The whole plane goes through the chirp filter at once:
 
+  unsigned int n_wires = _detector_properties_interface.n_wires(plane);
+  float * _plane_arr = &(_data_by_plane->at(plane).front());
 
-  // This function comes first, and determines if the waveform is chirping or not.
-  if (_chirp_filter.ChirpFilterAlg(_data_arr, N)) {
-
-    _chirp_info_by_plane[plane][wire] = _chirp_filter.get_current_chirp_info();
-    _wire_status_by_plane[plane][wire] = kChirping;
+  int n_chirping = _chirp_filter.ChirpFilterPlane(_plane_arr,
+                                                  n_wires,
+                                                  _n_time_ticks_data,
+                                                  _chirp_info_by_plane[plane]);
 
-    // if (_chirp_info_by_plane[plane][wire].chirp_start == 0 &&
-    //     _chirp_info_by_plane[plane][wire].chirp_stop != 9595 ) {
-    //   std::cout << "Wire " << wire << " on plane " << plane
-    //             << " chirps at the start." << std::endl;
-    // }
+  if (n_chirping == 0) {
+    return 0;
+  }
 
-    // then this channel is chirping, and we deal with it.
-    _chirp_filter.remove_baseline_deviation(_data_arr, N);
+  for (unsigned int wire = 0; wire < n_wires; wire ++) {
 
+    const chirp_info & _chirp = _chirp_info_by_plane[plane][wire];
+    if (!_chirp.chirping) {
+      continue;
+    }
 
-    return true;
-  } else {
-    // _chirp_filter.ZigzagFilterAlg(_data_arr, N);
-    return false;
+    _wire_status_by_plane[plane][wire] = kChirping;
 
+    // then this channel is chirping, and we deal with it.
+    _chirp_filter.remove_baseline_deviation(_plane_arr + wire * _n_time_ticks_data,
+                                            _n_time_ticks_data,
+                                            _chirp);
   }
 
+  return n_chirping;
+
 }
 
 void UbooneNoiseFilter::tag_special_wire_statuses() {
 
   // This function tags wires that are known to be dead, or in an otherwise
-  // weird state.
+  // weird state.  The list comes from the readout board map.
 
-  // Get the edge wires in the first plane that are very noisy
-  for (int wire = 0; wire < 16; wire++) {
-    _wire_status_by_plane[0][wire] = kHighNoise;
-  }
-  for (int wire = 2400 - 16 - 1; wire < 2400; wire++) {
-    _wire_status_by_plane[0][wire] = kHighNoise;
+  for (unsigned int plane = 0; plane < _detector_properties_interface.n_planes(); plane ++) {
+    for (auto const & range : _detector_properties_interface.noisy_wires(plane)) {
+      for (unsigned int wire = range.first; wire < range.second; wire++) {
+        _wire_status_by_plane[plane][wire] = kHighNoise;
+      }
+    }
   }
 }
 
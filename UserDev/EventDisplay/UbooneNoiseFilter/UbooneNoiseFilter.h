@@ -55,11 +55,14 @@
 #include <algorithm>
 #include <numeric>
 #include <map>
+#include <chrono>
 
 #include "NoiseFilterTypes.h"
 
 #include "ChirpFilter.h"
+#include "WaveformKernels.h"
 #include "CorrelatedNoiseFilter.h"
+#include "FrequencyNoiseFilter.h"
 /**
    \class UbooneNoiseFilter
    User defined class UbooneNoiseFilter ... these comments are used to generate
@@ -85,8 +88,12 @@ public:
 
   /**
    * @brief      Setup internal variables
+   * @details    The plane and wire layout is taken from the geometry, see
+   *             detPropFetcher.  Throws if the layout can't be built.
+   *
+   * @param geometry The geometry of the data to be filtered
    */
-  void init();
+  void init(const geo::GeometryCore & geometry);
 
   // Set the pointer to the data.  Only basic integrity checks are done,
   // but it's the calling class's responsibility to manage this memory.
@@ -131,6 +138,56 @@ public:
    */
   void set_n_time_ticks(unsigned int _n_time_ticks);
 
+  /**
+   * @brief Track pedestals from event to event instead of recomputing them
+   * @details When enabled, each wire's pedestal is seeded from the
+   *          previous event through an exponential tracker.  Each event only a
+   *          quick median of a few samples is taken; the full mean of medians
+   *          calculation is done only if the quick value is further than
+   *          the tolerance from the tracked pedestal.  Off by default.
+   *          Calling this resets any tracked values.
+   *
+   * @param _do_tracking Turn the tracking on or off
+   * @param _tolerance Allowed drift of the quick pedestal, in ADC
+   * @param _weight Weight of the new event in the exponential tracker
+   */
+  void set_pedestal_tracking(bool _do_tracking,
+                             float _tolerance = 1.0,
+                             float _weight = 0.1);
+
+  /**
+   * @brief Forget all tracked pedestals, the next event is computed in full
+   */
+  void reset_pedestal_tracking();
+
+  /**
+   * @brief Fraction of wires in the last event that used the tracked pedestal
+   */
+  float get_pedestal_skip_rate() const;
+
+  /**
+   * @brief Remove the harmonic noise in the frequency domain
+   * @details When enabled, every normal wire is filtered with the notches of
+   *          FrequencyNoiseFilter after pedestal subtraction, and the time
+   *          domain harmonic noise estimate of the correlated noise filter is
+   *          skipped.  Off by default.  The default notches are the 36 kHz
+   *          and 108 kHz harmonic noise lines; they can be changed through
+   *          get_frequency_filter.  Must be called after init.
+   *
+   * @param _use Turn the frequency domain filter on or off
+   * @param _n_threads Threads used for the FFTs, 0 means one per core
+   */
+  void set_frequency_filter(bool _use, unsigned int _n_threads = 0);
+
+  FrequencyNoiseFilter & get_frequency_filter() {return _freq_filter;}
+
+  /**
+   * @brief Wall time spent in each stage during the last event, in seconds
+   * @details Indexed by filterStage, see kSTAGE_NAME for the names.
+   *          pedestal_subtract_only only fills the first two stages.
+   */
+  const std::vector<double> & get_stage_times() const {return _stage_times;}
+
 
 private:
 
@@ -138,7 +195,8 @@ private:
   /**
    * @brief Applying a moving average to this wire.
    * @details Every bin gets replaced by the average of it and it's
-   *          next neighbor.  This essentially downsamples the wire.
+   *          next neighbor(s), see moving_average in WaveformKernels.h.
+   *          This essentially downsamples the wire.
    *          This is targeted to remove zig zag noise.
    *          Wire and plane info is used to deal with chirping wires
    *
@@ -163,6 +221,23 @@ private:
    */
   void get_pedestal_info(float * _data_arr, int N, int wire, int plane);
 
+  /**
+   * @brief Quick pedestal estimate used to validate the tracked pedestal
+   * @details Median of ~50 evenly spaced samples in [start_tick, end_tick)
+   */
+  float get_quick_pedestal(const float * _data_arr, int start_tick, int end_tick);
+
+  /**
+   * @brief Report the pedestal tracking skip rate for this event at kINFO, if tracking
+   */
+  void report_pedestal_tracking() const;
+
+  /**
+   * @brief Add the time since _start to a stage, return the current time
+   */
+  std::chrono::steady_clock::time_point
+  add_stage_time(filterStage stage, const std::chrono::steady_clock::time_point & _start);
+
   /**
    * @brief Reset all of the internal data to prepare for the next event.
    * @details This function clears internally stored data such as pedestals,
@@ -207,26 +282,17 @@ private:
 
 
   /**
-   * @brief Determine if a waveform is chirping.
-   * @details This function takes an input waveform, _data_arr,
-   *          and determines if chirping occurs anywhere along it.
-   *          If it does, it fills the internal data member _chirp_info_by_plane
-   *          at [plane][wire], while if it's not chirping _chirp_info_by_plane
-   *          is not modified.
+   * @brief Determine which wires in a plane are chirping.
+   * @details Runs the batched chirp detection over the whole plane and
+   *          fills _chirp_info_by_plane[plane], one entry per wire.
+   *          Chirping wires get the kChirping status, their chirping
+   *          region is zeroed and the baseline deviation after the chirp
+   *          is corrected as much as possible.
    *
-   *          The pointer to the data is the address of the start of the
-   *          wire in question.  So, if the wire is chirping, this function will
-   *          correct the chirping as much as possible
-   *
-   * @param _data_arr Pointer to array of data.  This points to the internal
-   *                  data array so modify with caution.
-   * @param N Length of the wire segment, nominally equal to _n_time_ticks.
-   *          Remove this input variable?
-   * @param wire The wire number of this waveform, used to fill _chirp_info_by_plane
-   * @param plane The plane of this waveform, used to fill _chirp_info_by_plane
-   * @return Boolean, true if the wire is chirping and false if it isn't.
+   * @param plane The plane to process
+   * @return The number of chirping wires in the plane
    */
-  bool is_chirping(float * _data_arr, int N, unsigned int wire, unsigned int plane);
+  int find_chirping_wires(unsigned int plane);
 
 
 
@@ -269,11 +335,19 @@ private:
 
   // const std::vector<int> _correlated_noise_steps = {48,48,96}
 
+  // Number of ticks averaged by apply_moving_average, and its scratch space
+  const int _moving_average_window = 2;
+  std::vector<double> _moving_average_scratch;
+
   // This is the chirping removal algorithm:
   ChirpFilter _chirp_filter;
 
   CorrelatedNoiseFilter _corr_filter;
 
+  // Optional frequency domain harmonic noise removal:
+  FrequencyNoiseFilter _freq_filter;
+  bool _use_frequency_filter = false;
+
   // All of the detector properties are encapsulated in this object
   // This allows larlite <-> larsoft transitions to be a little less painful
   ub_noise_filter::detPropFetcher _detector_properties_interface;
@@ -283,21 +357,33 @@ private:
   // filtering in place so it takes a pointer to the data.
   std::vector<std::vector<float> > * _data_by_plane;
 
-  unsigned int _n_time_ticks_data;
+  unsigned int _n_time_ticks_data = 9595;
   unsigned int _n_planes;
   std::vector<unsigned int> _n_wires_per_plane;
 
   std::vector<std::vector<float> > _pedestal_by_plane;
   std::vector<std::vector<float> > _rms_by_plane;
 
-  // This object contains the chirping info
-  // Since chirping is not really a common occurrence,
-  // this is store in a map to allow sparseness
-  std::vector<std::map<int, ::ub_noise_filter::chirp_info> > _chirp_info_by_plane;
+  // This object contains the chirping info, indexed by [plane][wire].
+  // Wires that are not chirping have chirping == false.
+  std::vector<std::vector<chirp_info> > _chirp_info_by_plane;
 
   // This vector deals with the wire status:
   std::vector<std::vector<wireStatus> > _wire_status_by_plane;
 
+  // Pedestal tracking between events, see set_pedestal_tracking
+  bool _track_pedestals = false;
+  float _pedestal_tolerance = 1.0;
+  float _pedestal_tracking_weight = 0.1;
+  std::vector<std::vector<float> > _tracked_pedestal_by_plane;
+  std::vector<std::vector<bool> > _pedestal_tracked_by_plane;
+  std::vector<float> _quick_pedestal_samples;
+  unsigned int _n_pedestals_skipped = 0;
+  unsigned int _n_pedestals_computed = 0;
+
+  // Time spent in each stage of the last event, see get_stage_times
+  std::vector<double> _stage_times;
+
 };
 
 } // ub_noise_filter
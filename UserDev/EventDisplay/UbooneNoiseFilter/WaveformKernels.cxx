@@ -0,0 +1,69 @@
+#ifndef WAVEFORMKERNELS_CXX
+#define WAVEFORMKERNELS_CXX
+
+#include "WaveformKernels.h"
+
+namespace ub_noise_filter {
+
+double window_sum(const float * wf, int start, int end) {
+
+  double sum = 0.0;
+  #pragma omp simd reduction(+:sum)
+  for (int tick = start; tick < end; tick ++) {
+    sum += wf[tick];
+  }
+  return sum;
+}
+
+void moving_average(float * wf,
+                    int start,
+                    int end,
+                    int window,
+                    std::vector<double> & _prefix_sum) {
+
+  if (window < 2 || end - start < window) {
+    return;
+  }
+
+  if (window == 2) {
+    // Tick t only reads t + 1, which has not been overwritten yet, so
+    // this is safe in place and vectorizes.  The product with 0.5f is
+    // exact so this matches the double precision average bit for bit.
+    for (int tick = start; tick < end - 1; tick ++) {
+      wf[tick] = 0.5f * (wf[tick] + wf[tick + 1]);
+    }
+    return;
+  }
+
+  // General window: prefix sum in double (sequential), then every output
+  // is the difference of two prefix sums (vectorized).
+  int n = end - start;
+  if (_prefix_sum.size() < (size_t) n + 1) {
+    _prefix_sum.resize(n + 1);
+  }
+  double * _prefix = &(_prefix_sum[0]);
+  const float * _in = wf + start;
+  _prefix[0] = 0.0;
+  for (int i = 0; i < n; i ++) {
+    _prefix[i + 1] = _prefix[i] + _in[i];
+  }
+
+  float * _out = wf + start;
+  const double inv_window = 1.0 / window;
+  #pragma omp simd
+  for (int i = 0; i <= n - window; i ++) {
+    _out[i] = (_prefix[i + window] - _prefix[i]) * inv_window;
+  }
+}
+
+void subtract_scaled(float * wf, const float * shape, int n, float scale) {
+
+  #pragma omp simd
+  for (int i = 0; i < n; i ++) {
+    wf[i] -= scale * shape[i];
+  }
+}
+
+} // ub_noise_filter
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * \file WaveformKernels.h
+ *
+ * \ingroup RawViewer
+ *
+ * \brief Single wire kernels shared by the noise filter classes
+ *
+ * These functions work in place on the float array of one wire.  Each one
+ * is a single pass over the samples (no per-sample window recomputation),
+ * written as plain loops over contiguous memory so the compiler can
+ * vectorize them.
+ *
+ * @author cadams
+ */
+
+/** \addtogroup RawViewer
+
+    @{*/
+#ifndef WAVEFORMKERNELS_H
+#define WAVEFORMKERNELS_H
+
+#include <cstddef>
+#include <vector>
+
+namespace ub_noise_filter {
+
+/**
+ * @brief Sum of the samples in [start, end)
+ * @details Accumulates in double precision.  Returns 0 for an empty range.
+ */
+double window_sum(const float * wf, int start, int end);
+
+/**
+ * @brief In place forward moving average over [start, end)
+ * @details Every tick t in [start, end - window] is replaced by the mean
+ *          of the samples [t, t + window).  The last window - 1 ticks
+ *          of the range are left untouched.  Window 2 (the zig zag filter)
+ *          is a single vectorized pass; larger windows use a prefix sum.
+ *
+ * @param wf The wire data
+ * @param start First tick of the range
+ * @param end One past the last tick of the range
+ * @param window Number of ticks averaged
+ * @param _prefix_sum Scratch space for the prefix sum, resized as needed
+ */
+void moving_average(float * wf,
+                    int start,
+                    int end,
+                    int window,
+                    std::vector<double> & _prefix_sum);
+
+/**
+ * @brief wf[i] -= scale * shape[i] for i in [0, n)
+ */
+void subtract_scaled(float * wf, const float * shape, int n, float scale);
+
+} // ub_noise_filter
+
+#endif
+/** @} */ // end of doxygen group
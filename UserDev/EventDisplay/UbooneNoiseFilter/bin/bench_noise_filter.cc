@@ -0,0 +1,262 @@
+//
+// Benchmark of UbooneNoiseFilter::clean_data on synthetic events.
+//
+// Each event is built from the detector layout of the noise filter:
+//   - a pedestal per wire
+//   - gaussian noise on every wire
+//   - coherent noise, one waveform per correlated noise block
+//   - harmonic noise, one sine per plane scaled by wire length
+//   - a few chirping wires (flat at the start of the wire)
+//   - a few straight tracks, unipolar on the collection plane and
+//     bipolar on the induction planes
+//
+// The time of each filter stage is printed, along with the throughput and
+// two quality numbers on the normal wires, compared to the true signal:
+//   residual : RMS of (filtered - truth), in ADC, away from chirping regions
+//   signal   : fraction of the true track charge left after filtering
+//
+// Usage:
+//   > bench_noise_filter services.fcl [n_events] [n_ticks] [frequency_filter] [n_threads]
+//
+// services.fcl configures the Geometry service (MicroBooNE layout, standard
+// channel map) that the noise filter takes its wire layout from.
+// frequency_filter is 0 (default) or 1, see UbooneNoiseFilter::set_frequency_filter
+//
+
+#include "UbooneNoiseFilter/UbooneNoiseFilter.h"
+
+#include "larcorealg/Geometry/ChannelMapStandardAlg.h"
+#include "larcorealg/Geometry/StandaloneBasicSetup.h"
+#include "larcorealg/Geometry/StandaloneGeometrySetup.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+using namespace ub_noise_filter;
+
+struct synthetic_event {
+  // [plane][wire * n_ticks + tick]
+  std::vector<std::vector<float> > data;
+  std::vector<std::vector<float> > truth;
+  // [plane][wire], last chirping tick (0 if not chirping)
+  std::vector<std::vector<int> > chirp_end;
+};
+
+void make_event(detPropFetcher & detector,
+                int n_ticks,
+                std::mt19937 & gen,
+                synthetic_event & event)
+{
+  std::normal_distribution<float> gaus(0.0, 1.0);
+  std::uniform_real_distribution<float> flat(0.0, 1.0);
+
+  const float noise_rms[3] = {3.0, 3.0, 2.5};
+  const float coherent_rms = 4.0;
+  const float harmonic_amplitude = 3.0;
+  const float harmonic_frequency = 0.036;  // MHz
+  const float tick_period = 0.5;           // us
+  const float chirp_fraction = 0.01;
+  const int n_tracks = 5;
+
+  unsigned int n_planes = detector.n_planes();
+  event.data.resize(n_planes);
+  event.truth.resize(n_planes);
+  event.chirp_end.resize(n_planes);
+
+  for (unsigned int plane = 0; plane < n_planes; plane ++) {
+
+    int n_wires = detector.n_wires(plane);
+    std::vector<float> & data = event.data[plane];
+    std::vector<float> & truth = event.truth[plane];
+    data.assign((size_t) n_wires * n_ticks, 0.0);
+    truth.assign((size_t) n_wires * n_ticks, 0.0);
+    event.chirp_end[plane].assign(n_wires, 0);
+
+    // Coherent noise: a smoothed random walk per block
+    int n_blocks = detector.correlated_noise_blocks(plane).size() - 1;
+    std::vector<std::vector<float> > coherent(n_blocks, std::vector<float>(n_ticks, 0.0));
+    for (auto & waveform : coherent) {
+      float val = 0.0;
+      for (int tick = 0; tick < n_ticks; tick ++) {
+        val = 0.98 * val + 0.2 * coherent_rms * gaus(gen);
+        waveform[tick] = val;
+      }
+    }
+
+    // Harmonic noise, the same phase on the whole plane
+    float phase = 2 * M_PI * flat(gen);
+    std::vector<float> harmonic(n_ticks);
+    for (int tick = 0; tick < n_ticks; tick ++) {
+      harmonic[tick] = harmonic_amplitude *
+                       std::sin(2 * M_PI * harmonic_frequency * tick * tick_period + phase);
+    }
+
+    // Tracks: straight lines in (wire, tick)
+    for (int i_track = 0; i_track < n_tracks; i_track ++) {
+      int wire_start = flat(gen) * n_wires * 0.8;
+      int wire_end = wire_start + (0.1 + 0.1 * flat(gen)) * n_wires;
+      float tick_start = 500 + flat(gen) * (n_ticks - 1000);
+      float slope = (flat(gen) - 0.5) * 4.0;
+      for (int wire = wire_start; wire < wire_end && wire < n_wires; wire ++) {
+        float t0 = tick_start + slope * (wire - wire_start);
+        if (t0 < 20 || t0 > n_ticks - 20) continue;
+        float * wire_truth = &(truth[(size_t) wire * n_ticks]);
+        for (int tick = t0 - 15; tick < t0 + 15; tick ++) {
+          float x = (tick - t0) / 3.0;
+          if (plane == n_planes - 1) {
+            wire_truth[tick] += 40.0 * std::exp(-0.5 * x * x);
+          }
+          else {
+            wire_truth[tick] += -30.0 * x * std::exp(-0.5 * x * x);
+          }
+        }
+      }
+    }
+
+    for (int wire = 0; wire < n_wires; wire ++) {
+      float pedestal = (plane == n_planes - 1 ? 473.0 : 2046.0) + 5.0 * flat(gen);
+      float scale = detector.wire_scale(plane, wire);
+      const std::vector<float> & block_noise = coherent[detector.block(plane, wire)];
+      float * wire_data = &(data[(size_t) wire * n_ticks]);
+      const float * wire_truth = &(truth[(size_t) wire * n_ticks]);
+
+      for (int tick = 0; tick < n_ticks; tick ++) {
+        wire_data[tick] = pedestal + wire_truth[tick]
+                          + noise_rms[std::min(plane, 2u)] * gaus(gen)
+                          + block_noise[tick]
+                          + scale * harmonic[tick];
+      }
+
+      // Chirping: the wire is flat at the start
+      if (flat(gen) < chirp_fraction) {
+        int chirp_end = 500 + flat(gen) * n_ticks / 4;
+        for (int tick = 0; tick < chirp_end; tick ++) {
+          wire_data[tick] = pedestal;
+        }
+        event.chirp_end[plane][wire] = chirp_end;
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+
+  int n_events = 5;
+  int n_ticks = 9595;
+  bool use_frequency_filter = false;
+  unsigned int n_threads = 0;
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0]
+              << " services.fcl [n_events] [n_ticks] [frequency_filter] [n_threads]"
+              << std::endl;
+    return 1;
+  }
+  if (argc > 2) n_events = std::atoi(argv[2]);
+  if (argc > 3) n_ticks = std::atoi(argv[3]);
+  if (argc > 4) use_frequency_filter = std::atoi(argv[4]);
+  if (argc > 5) n_threads = std::atoi(argv[5]);
+
+  detPropFetcher detector;
+  UbooneNoiseFilter filter;
+  try {
+    auto pset = lar::standalone::ParseConfiguration(argv[1]);
+    auto geometry = lar::standalone::SetupGeometry<geo::ChannelMapStandardAlg>
+                    (pset.get<fhicl::ParameterSet>("services.Geometry"));
+    detector.init(*geometry);
+    filter.init(*geometry);
+    filter.set_n_time_ticks(n_ticks);
+    filter.set_frequency_filter(use_frequency_filter, n_threads);
+  }
+  catch (const std::exception & e) {
+    std::cerr << "ERROR: could not set up the noise filter, " << e.what() << std::endl;
+    return 1;
+  }
+
+  size_t n_wires_total = 0;
+  for (unsigned int plane = 0; plane < detector.n_planes(); plane ++) {
+    n_wires_total += detector.n_wires(plane);
+  }
+
+  std::cout << "Noise filter benchmark: " << n_events << " events, "
+            << n_ticks << " ticks, " << n_wires_total << " wires, "
+            << "frequency filter " << (use_frequency_filter ? "on" : "off")
+            << std::endl;
+
+  std::mt19937 gen(12345);
+  synthetic_event event;
+
+  std::vector<double> stage_total(kNStages, 0.0);
+  double time_total = 0.0;
+  double residual_sum2 = 0.0;
+  double residual_n = 0.0;
+  double signal_true = 0.0;
+  double signal_kept = 0.0;
+
+  for (int i_event = 0; i_event < n_events; i_event ++) {
+
+    make_event(detector, n_ticks, gen, event);
+
+    auto start = std::chrono::steady_clock::now();
+    filter.set_data(&event.data);
+    filter.clean_data();
+    auto stop = std::chrono::steady_clock::now();
+
+    double event_time = std::chrono::duration<double>(stop - start).count();
+    time_total += event_time;
+    for (int stage = 0; stage < kNStages; stage ++) {
+      stage_total[stage] += filter.get_stage_times()[stage];
+    }
+
+    // Quality, only on wires the filter kept as normal:
+    const std::vector<std::vector<wireStatus> > & status = filter.get_wire_status_by_plane();
+    for (unsigned int plane = 0; plane < detector.n_planes(); plane ++) {
+      for (unsigned int wire = 0; wire < detector.n_wires(plane); wire ++) {
+        if (status[plane][wire] != kNormal || event.chirp_end[plane][wire] != 0) {
+          continue;
+        }
+        const float * wire_data = &(event.data[plane][(size_t) wire * n_ticks]);
+        const float * wire_truth = &(event.truth[plane][(size_t) wire * n_ticks]);
+        for (int tick = 0; tick < n_ticks; tick ++) {
+          double diff = wire_data[tick] - wire_truth[tick];
+          residual_sum2 += diff * diff;
+          residual_n ++;
+          if (wire_truth[tick] > 1.0) {
+            signal_true += wire_truth[tick];
+            signal_kept += wire_data[tick];
+          }
+        }
+      }
+    }
+
+    std::cout << "  event " << i_event << ": " << std::fixed << std::setprecision(3)
+              << event_time << " s" << std::endl;
+  }
+
+  std::cout << std::endl << "Time per event by stage:" << std::endl;
+  for (int stage = 0; stage < kNStages; stage ++) {
+    std::cout << std::setw(14) << kSTAGE_NAME[stage]
+              << std::setw(10) << std::fixed << std::setprecision(3)
+              << stage_total[stage] / n_events << " s" << std::endl;
+  }
+  std::cout << std::setw(14) << "total"
+            << std::setw(10) << time_total / n_events << " s" << std::endl;
+
+  double mb_per_event = n_wires_total * n_ticks * sizeof(float) / 1.0e6;
+  std::cout << std::endl
+            << "Throughput : " << std::setprecision(0) << n_wires_total * n_events / time_total
+            << " wires/s, " << std::setprecision(1) << mb_per_event * n_events / time_total
+            << " MB/s" << std::endl;
+  std::cout << "Residual   : " << std::setprecision(3)
+            << (residual_n > 0 ? std::sqrt(residual_sum2 / residual_n) : 0.0)
+            << " ADC RMS" << std::endl;
+  std::cout << "Signal     : " << (signal_true > 0 ? signal_kept / signal_true : 0.0)
+            << " of the true charge" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,158 @@
+//
+// Benchmark of the single wire kernels in WaveformKernels.h against the
+// sample by sample loops they replaced.
+//
+// Usage:
+//   > bench_waveform_kernels [n_wires] [n_repeat]
+//
+// Prints the cost per wire, in microseconds, at 4096 and 6400 ticks.
+//
+
+#include "UbooneNoiseFilter/WaveformKernels.h"
+#include "UbooneNoiseFilter/ChirpFilter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+// The moving average as it was in UbooneNoiseFilter::apply_moving_average
+void reference_zig_zag(float * wf, int N) {
+  for (int tick = 0; tick < N - 1 ; tick ++) {
+    wf[tick] = 0.5 * (wf[tick] + wf[tick + 1]);
+  }
+}
+
+// A moving average that recomputes every window
+void reference_moving_average(float * wf, int N, int window) {
+  for (int tick = 0; tick <= N - window; tick ++) {
+    double sum = 0.0;
+    for (int i = 0; i < window; i ++) {
+      sum += wf[tick + i];
+    }
+    wf[tick] = sum / window;
+  }
+}
+
+// The baseline correction as it was in ChirpFilter::remove_baseline_deviation
+// (without the read past the end of the wire)
+void reference_baseline(float * wf, int numTicks, int chirp_stop,
+                        float rc_const, const std::vector<float> & shape) {
+  double integral = 0.0;
+  double n_integral = 0;
+  double baseline = 0.0;
+  double n_baseline = 0;
+  for (int tick = 0; tick < rc_const; tick ++ ) {
+    if (chirp_stop + tick < numTicks) {
+      integral += wf[chirp_stop + tick];
+      n_integral ++;
+    }
+  }
+  for (int tick = numTicks - 1;
+       tick >= chirp_stop + rc_const &&
+       tick >= numTicks - rc_const;
+       tick --) {
+    baseline += wf[tick];
+    n_baseline ++;
+  }
+  baseline /= n_baseline;
+  double amplitude = integral - n_integral * baseline;
+  amplitude /= (rc_const * (1 - exp(-n_integral / rc_const)));
+  for (int tick = chirp_stop; tick < numTicks; tick ++ ) {
+    size_t exp_tick = tick - chirp_stop;
+    if (exp_tick >= shape.size())
+      break;
+    wf[tick] -= (amplitude) * shape[exp_tick];
+  }
+}
+
+// Time a per wire function over a copy of the plane, in microseconds per wire
+template <class F>
+double time_per_wire(const std::vector<float> & plane, int n_wires, int n_ticks,
+                     int n_repeat, F func) {
+  std::vector<float> work(plane);
+  double total = 0.0;
+  for (int r = 0; r < n_repeat; r ++) {
+    std::copy(plane.begin(), plane.end(), work.begin());
+    auto start = std::chrono::steady_clock::now();
+    for (int wire = 0; wire < n_wires; wire ++) {
+      func(&(work[0]) + wire * n_ticks, n_ticks);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    total += std::chrono::duration<double, std::micro>(stop - start).count();
+  }
+  return total / (n_repeat * n_wires);
+}
+
+int main(int argc, char** argv) {
+
+  int n_wires = 512;
+  int n_repeat = 20;
+  if (argc > 1) n_wires = std::atoi(argv[1]);
+  if (argc > 2) n_repeat = std::atoi(argv[2]);
+
+  const float rc_const = 835.0;
+  const int chirp_stop = 500;
+  std::vector<float> shape(4000);
+  for (size_t tick = 0; tick < shape.size(); tick ++) {
+    shape[tick] = exp(-1.0 * tick / rc_const);
+  }
+
+  // The shipped baseline correction, for a wire that chirps from tick 0
+  ub_noise_filter::ChirpFilter chirp_filter;
+  ub_noise_filter::chirp_info chirp;
+  chirp.chirp_start = 0;
+  chirp.chirp_stop = chirp_stop;
+  chirp.chirping = true;
+
+  std::vector<double> scratch;
+  std::mt19937 gen(12345);
+  std::normal_distribution<float> noise(0.0, 2.5);
+
+  std::cout << "Cost per wire in microseconds, " << n_wires << " wires, "
+            << n_repeat << " repeats" << std::endl;
+  std::cout << std::setw(8) << "ticks"
+            << std::setw(24) << "kernel"
+            << std::setw(12) << "before"
+            << std::setw(12) << "after"
+            << std::setw(10) << "speedup" << std::endl;
+
+  for (int n_ticks : {4096, 6400}) {
+
+    std::vector<float> plane(n_wires * n_ticks);
+    for (auto & val : plane) val = noise(gen);
+
+    auto report = [&](const char * name, double before, double after) {
+      std::cout << std::setw(8) << n_ticks
+                << std::setw(24) << name
+                << std::setw(12) << std::fixed << std::setprecision(3) << before
+                << std::setw(12) << after
+                << std::setw(9) << std::setprecision(1) << before / after << "x"
+                << std::endl;
+    };
+
+    report("moving average (2)",
+           time_per_wire(plane, n_wires, n_ticks, n_repeat,
+                         [](float * wf, int N) {reference_zig_zag(wf, N);}),
+           time_per_wire(plane, n_wires, n_ticks, n_repeat,
+    [&](float * wf, int N) {ub_noise_filter::moving_average(wf, 0, N, 2, scratch);}));
+
+    report("moving average (10)",
+           time_per_wire(plane, n_wires, n_ticks, n_repeat,
+                         [](float * wf, int N) {reference_moving_average(wf, N, 10);}),
+           time_per_wire(plane, n_wires, n_ticks, n_repeat,
+    [&](float * wf, int N) {ub_noise_filter::moving_average(wf, 0, N, 10, scratch);}));
+
+    report("baseline deviation",
+           time_per_wire(plane, n_wires, n_ticks, n_repeat,
+    [&](float * wf, int N) {reference_baseline(wf, N, chirp_stop, rc_const, shape);}),
+           time_per_wire(plane, n_wires, n_ticks, n_repeat,
+    [&](float * wf, int N) {chirp_filter.remove_baseline_deviation(wf, N, chirp);}));
+  }
+
+  return 0;
+}
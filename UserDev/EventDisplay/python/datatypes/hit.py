@@ -2,6 +2,7 @@ from datatypes.database import recoBase
 from ROOT import evd
 from pyqtgraph.Qt import QtGui
 import pyqtgraph as pg
+import numpy as np
 
 
 class hit(recoBase):
@@ -16,6 +17,8 @@ class hit(recoBase):
         self.init()
 
     # this is the function that actually draws the hits.
+    # The hits of a plane come back from c++ as numpy columns, and are drawn
+    # with one item per opacity level instead of one item per hit.
     def drawObjects(self, view_manager):
 
         geom = view_manager._geometry
@@ -23,27 +26,33 @@ class hit(recoBase):
             thisPlane = view.plane()
             self._drawnObjects.append([])
             # First get the hit information:
-            hits = self._process.getDataByPlane(thisPlane)
-
-            for i in range(len(hits)):
-                hit = hits[i]
-                # Draws a rectangle at (x,y,xlength, ylength)
-                r = QtGui.QGraphicsRectItem(
-                    hit.wire(), hit.time() + geom.timeOffsetTicks(view.plane()), 1, hit.rms())
-
-                opacity = int(128 * hit.charge() / self._process.maxCharge(thisPlane)) + 127
-                # opacity = exp( 1 + hit.charge() / self._process.maxCharge(thisPlane))/exp(2);
-                # # New Way
-                # r.setPen(pg.mkPen(brush,width=2))
-                # # r.setBrush(pg.mkColor((255,255,255)))
-
-                # Old Way:
-                r.setPen(pg.mkPen(None))
-                r.setBrush(pg.mkColor(0,0,0,opacity))
-                # r.setBrush((0,0,0,opacity))
+            hits = self._process.getHitColumnsByPlane(thisPlane)
+            if hits is None or len(hits['wire']) == 0:
+                continue
+
+            maxCharge = self._process.maxCharge(thisPlane)
+            if maxCharge <= 0:
+                maxCharge = 1.0
+            opacity = (128 * hits['charge'] / maxCharge).astype(int) + 127
+            opacity = np.clip(opacity, 0, 255)
+
+            # Each hit is a rectangle at (wire, time), 1 wire wide and rms tall
+            x0 = hits['wire']
+            y0 = hits['peak_time'] + geom.timeOffsetTicks(thisPlane)
+            height = hits['rms']
+
+            for level in np.unique(opacity):
+                selected = opacity == level
+                r = pg.BarGraphItem(x0=x0[selected],
+                                    y0=y0[selected],
+                                    width=1,
+                                    height=height[selected],
+                                    pen=pg.mkPen(None),
+                                    brush=pg.mkColor(0, 0, 0, int(level)))
                 self._drawnObjects[thisPlane].append(r)
                 view._view.addItem(r)
 
+    # Hits on one wire, sorted by time, as numpy views (see drawObjects)
     def getHitsOnWire(self, plane, wire):
-        return self._process.getHitsOnWirePlane(wire,plane)
+        return self._process.getHitColumnsOnWires(wire, wire + 1, plane)
         
\ No newline at end of file
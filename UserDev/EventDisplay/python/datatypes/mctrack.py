@@ -3,10 +3,10 @@ from pyqtgraph.Qt import QtGui, QtCore
 from ROOT import evd
 import pyqtgraph as pg
 
-from datatypes.track import polyLine
+from datatypes.track import trackBase
 
 
-class mctrack(recoBase):
+class mctrack(trackBase):
 
     def __init__(self,detectorConfig):
         super(mctrack, self).__init__()
@@ -14,44 +14,12 @@ class mctrack(recoBase):
         self._process = evd.DrawMCTrack(detectorConfig._geometryCore,detectorConfig._detectorProperties)
         self.init()
 
-    def drawObjects(self, view_manager):
-        geom = view_manager._geometry
-
-        for view in view_manager.getViewPorts():
-            #   # get the showers from the process:
-            self._drawnObjects.append([])
-            tracks = self._process.getDataByPlane(view.plane())
-            offset = geom.offset(view.plane()) / geom.time2cm()
-
-            for i in range(len(tracks)):
-                track = tracks[i]
-                # construct a polygon for this track:
-                points = []
-                # Remeber - everything is in cm, but the display is in
-                # wire/time!
-                for pair in track.track():
-                    x = pair.first / geom.wire2cm()
-                    y = pair.second / geom.time2cm() + offset
-                    points.append(QtCore.QPointF(x, y))
-
-                # self._drawnObjects[view.plane()].append(thisPoly)
-
-                if len(points) == 0:
-                    continue
-
-                thisPoly = polyLine(points)
-
-                origin = track.origin()
-                if (origin == 1): # neutrino origin
-                    pen = pg.mkPen((128,128,128), width=2)
-                else:
-                    pen = pg.mkPen((0,0,0), width=2)
-                thisPoly.setPen(pen)
-                # polyLine.draw(view._view)
-
-                view._view.addItem(thisPoly)
-
-                self._drawnObjects[view.plane()].append(thisPoly)
+    def trackPen(self, track):
+        origin = track.origin()
+        if (origin == 1): # neutrino origin
+            return pg.mkPen((128,128,128), width=2)
+        else:
+            return pg.mkPen((0,0,0), width=2)
 
 
 from datatypes.database import recoBase3D
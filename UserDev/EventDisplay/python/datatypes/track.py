@@ -2,36 +2,74 @@ from datatypes.database import recoBase
 from pyqtgraph.Qt import QtGui, QtCore
 from ROOT import evd
 import pyqtgraph as pg
+import math
+import functools
 
 
 class polyLine(QtGui.QGraphicsPathItem):
 
     def __init__(self, points, pen=None):
         super(polyLine, self).__init__()
-        self._points = points
 
-        # Initialize a path:
-        path = QtGui.QPainterPath()
         if pen is None:
             pen = QtGui.QPen(QtCore.Qt.black)
         self.setPen(pen)
 
+        self.setPoints(points)
+
+    def setPoints(self, points):
+        self._points = points
+
         # Fill the path:
+        path = QtGui.QPainterPath()
         path.moveTo(points[0])
         for i in range(len(points)-1):
             path.lineTo(points[i+1])
         self.setPath(path)
 
 
-class track(recoBase):
+# Tracks are drawn with points at most this many pixels off the full track
+_pixelTolerance = 0.5
 
-    def __init__(self,detectorConfig):
-        super(track, self).__init__()
-        self._productName = 'track'
-        self._process = evd.DrawTrack(detectorConfig._geometryCore,detectorConfig._detectorProperties)
-        self.init()
+
+def trackTolerance(view, geom):
+    """Tolerance (cm) for track(tolerance) at the current zoom of this view.
+
+    Rounded down to a power of 2, so small zooms keep the same level."""
+    px, py = view._view.viewPixelSize()
+    cmPerPixel = min(px * geom.wire2cm(), py * geom.time2cm())
+    if cmPerPixel <= 0:
+        return 0.0
+    return 2.0**math.floor(math.log(_pixelTolerance * cmPerPixel, 2))
+
+
+def trackPoints(track, tolerance, geom, plane):
+    # Remeber - everything is in cm, but the display is in
+    # wire/time!
+    offset = geom.offset(plane) / geom.time2cm()
+    points = []
+    for pair in track.track(tolerance):
+        x = pair.first / geom.wire2cm()
+        y = pair.second / geom.time2cm() + offset
+        points.append(QtCore.QPointF(x, y))
+    return points
 
 
+class trackBase(recoBase):
+
+    """Tracks drawn as polylines, at the level of detail of the zoom.
+
+    When a view is zoomed to a new level, the paths of that view
+    are rebuilt from the same tracks with the new tolerance."""
+
+    def __init__(self):
+        super(trackBase, self).__init__()
+        self._drawnTracks = {}
+        self._zoomHandlers = {}
+
+    def trackPen(self, track):
+        return pg.mkPen((130,0,0), width=2)
+
     def drawObjects(self, view_manager):
         geom = view_manager._geometry
 
@@ -39,29 +77,55 @@ class track(recoBase):
             #   # get the showers from the process:
             self._drawnObjects.append([])
             tracks = self._process.getDataByPlane(view.plane())
-            offset = geom.offset(view.plane()) / geom.time2cm()
+            tolerance = trackTolerance(view, geom)
 
+            drawn = []
             for i in range(len(tracks)):
                 track = tracks[i]
                 # construct a polygon for this track:
-                points = []
-                # Remeber - everything is in cm, but the display is in
-                # wire/time!
-                for pair in track.track():
-                    x = pair.first / geom.wire2cm()
-                    y = pair.second / geom.time2cm() + offset
-                    points.append(QtCore.QPointF(x, y))
-
-                # self._drawnObjects[view.plane()].append(thisPoly)
+                points = trackPoints(track, tolerance, geom, view.plane())
+                if len(points) == 0:
+                    continue
 
                 thisPoly = polyLine(points)
-                pen = pg.mkPen((130,0,0), width=2)
-                thisPoly.setPen(pen)
-                # polyLine.draw(view._view)
-            
+                thisPoly.setPen(self.trackPen(track))
+
                 view._view.addItem(thisPoly)
 
                 self._drawnObjects[view.plane()].append(thisPoly)
+                drawn.append((track, thisPoly))
+
+            self._drawnTracks[view.plane()] = [tolerance, drawn]
+            handler = functools.partial(self.zoomHandler, view, geom)
+            view._view.sigRangeChanged.connect(handler)
+            self._zoomHandlers[view.plane()] = (view, handler)
+
+    def zoomHandler(self, view, geom, *args):
+        if view.plane() not in self._drawnTracks:
+            return
+        tolerance = trackTolerance(view, geom)
+        drawn = self._drawnTracks[view.plane()]
+        if tolerance == drawn[0]:
+            return
+        drawn[0] = tolerance
+        for track, poly in drawn[1]:
+            poly.setPoints(trackPoints(track, tolerance, geom, view.plane()))
+
+    def clearDrawnObjects(self, view_manager):
+        for view, handler in self._zoomHandlers.values():
+            view._view.sigRangeChanged.disconnect(handler)
+        self._zoomHandlers = {}
+        self._drawnTracks = {}
+        super(trackBase, self).clearDrawnObjects(view_manager)
+
+
+class track(trackBase):
+
+    def __init__(self,detectorConfig):
+        super(track, self).__init__()
+        self._productName = 'track'
+        self._process = evd.DrawTrack(detectorConfig._geometryCore,detectorConfig._detectorProperties)
+        self.init()
 
 
 from datatypes.database import recoBase3D
@@ -43,6 +43,8 @@ class rawDigit(wire):
         super(rawDigit, self).__init__()
         print("  >>> initializing the DrawRawDigit object")
         self._process = evd.DrawRawDigit(detectorConfig._geometryCore,detectorConfig._detectorProperties)
+        # Keep the raw and filtered planes so toggling the filter is only a swap
+        self._process.SetKeepRawAndFiltered(True)
         for i in range(len(detectorConfig._pedestals)):
             self._process.setPedestal(detectorConfig._pedestals[i], i)
         self._process.initialize()
@@ -50,6 +50,12 @@ def main():
     geom.add_argument('-I', '-i', '--icarus',
                       action='store_true',
                       help="Run with the ICARUS geometry")
+    parser.add_argument('-j', '--concurrent',
+                        action='store_true',
+                        help="Run the drawers of an event concurrently")
+    parser.add_argument('-p', '--profile',
+                        action='store_true',
+                        help="Print the time each drawer takes on every event")
     parser.add_argument('file', nargs='*', help="Optional input file to use")
 
     args = parser.parse_args()
@@ -72,6 +78,8 @@ def main():
     # If a file was passed, give it to the manager:
 
     manager = evd_manager_2D(geom)
+    manager.setConcurrent(args.concurrent)
+    manager.setProfile(args.profile)
     manager.setInputFiles(args.file)
 
 
@@ -2,8 +2,10 @@ from pyqtgraph.Qt import QtCore
 from evdmanager.event import manager, event
 import datatypes
 from ROOT import gallery
+from ROOT import galleryfmwk
+import bisect
 import os
-from ROOT import TFile
+import zlib
 import ROOT
 
 
@@ -64,15 +66,52 @@ class processer(object):
         # Storing ana units as a map:
         # self._ana_units[data product] -> instance of ana_unit
         self._ana_units = dict()
-        pass
+
+        # In concurrent mode the ana units that read different products
+        # run at the same time, see galleryfmwk::anascheduler
+        self._concurrent = False
+        self._scheduler = None
+
+        # Time and memory of every analyze call, see galleryfmwk::anaprofiler
+        self._profiler = None
+
+    def set_concurrent(self, concurrent=True):
+        self._concurrent = concurrent
+
+    def set_profile(self, profile=True):
+        if profile and self._profiler is None:
+            self._profiler = galleryfmwk.anaprofiler()
+        elif not profile:
+            self._profiler = None
+
+    def profiler(self):
+        return self._profiler
 
     def process_event(self, gallery_event):
         # print "Running ... "
         print("  ==> prcessing event, ana_units len:",len(self._ana_units))
         print(self._ana_units)
-        for key in self._ana_units:
-#            print("Processing " + key)
-            self._ana_units[key].analyze(gallery_event)
+        if self._concurrent:
+            if self._scheduler is None:
+                self._scheduler = galleryfmwk.anascheduler()
+            self._scheduler.clear()
+            for key in self._ana_units:
+                self._scheduler.add_process(self._ana_units[key])
+            self._scheduler.set_profiler(self._profiler)
+            # Returns once every ana unit is done, before anything is drawn
+            self._scheduler.process_event(gallery_event)
+        else:
+            for key in self._ana_units:
+#                print("Processing " + key)
+                unit = self._ana_units[key]
+                if self._profiler is None:
+                    unit.analyze(gallery_event)
+                    continue
+                start = self._profiler.start()
+                unit.analyze(gallery_event)
+                self._profiler.stop(unit, galleryfmwk.anaprofiler.kANALYZE, start)
+        if self._profiler is not None:
+            self._profiler.report(galleryfmwk.anaprofiler.kANALYZE)
 
     def add_process(self, data_product, ana_unit):
         print("-->> Adding process, data_product type:",type(data_product))
@@ -92,7 +131,7 @@ class processer(object):
         else:
             return None
 
-    def reset():
+    def reset(self):
         self._ana_units = dict()
 
 class evd_manager_base(manager, QtCore.QObject):
@@ -111,6 +150,18 @@ class evd_manager_base(manager, QtCore.QObject):
         # self._mgr = fmwk.storage_manager()
         self._data_manager = None
 
+        # Where every event of the files is, see galleryfmwk::eventindex
+        self._index = galleryfmwk.eventindex()
+        self._file_list = []
+        # First entry of each file then the number of entries, when the
+        # files could not be indexed
+        self._file_first = [0]
+        # File of the list _data_manager starts at
+        self._file = -1
+
+        # Products of each file, cached by file GUID, see galleryfmwk::productcache
+        self._products = galleryfmwk.productcache()
+
         self._keyTable = dict()
         self._drawnClasses = dict()
 
@@ -136,29 +187,31 @@ class evd_manager_base(manager, QtCore.QObject):
         # This function opens the file to see
         # what data products are available
 
-        # Open the file
-        f = TFile(file)
-        # Use the larlite_id_tree to find out how many entries are in the file:
-        e=f.Get("Events")
+        # The branches of the Events tree, only the file header is
+        # read if the file was opened before
+        if not self._products.open(file, self.productCachePath()):
+            return
 
         # prepare a dictionary of data products
         lookUpTable = dict()
         lookUpTable.update({"all" : dict()})
 
         product_list = []
-        # Loop over the keys (list of trees)
-        for key in e.GetListOfBranches():
+        # Loop over the branches
+        for i in range(self._products.size()):
+            name = str(self._products.name(i))
+            typeName = str(self._products.type(i))
 
-            if key.GetTypeName() == 'art::EventAuxiliary':
+            if typeName == 'art::EventAuxiliary':
                 continue
 
-            if "NuMu" in key.GetName() and "Assns" in key.GetTypeName():
-                if "PFParticle" in key.GetTypeName():
+            if "NuMu" in name and "Assns" in typeName:
+                if "PFParticle" in typeName:
                     continue
-            elif "Assns" in key.GetTypeName():
+            elif "Assns" in typeName:
                 continue
 
-            prod=product(key.GetName(), key.GetTypeName())
+            prod=product(name, typeName)
 
 
             # if "NuMu" in key.GetName():
@@ -167,7 +220,7 @@ class evd_manager_base(manager, QtCore.QObject):
             #     print "NuMu type name is " + str(prod.typeName())
             _product = prod._typeName
 
-            print("   - product: ", _product, ", ==key: ",key)
+            print("   - product: ", _product, ", ==key: ",name)
 
 
             # Add the product to the "all" list and 
@@ -229,20 +282,35 @@ class evd_manager_base(manager, QtCore.QObject):
 
             # Finally, ping the file to see what is available to draw
             self.pingFile(file)
-            if len(self._keyTable['all']) > 0:
+            if len(self._keyTable.get('all', ())) > 0:
                 self._hasFile = True
-                _file_list.push_back(file)
+                _file_list.push_back(os.path.abspath(file))
 
+        self._file_list = [str(_f) for _f in _file_list]
 
-        # Have to figure out number of events available
-        for _f in _file_list:
-            _rf = ROOT.TFile(_f)
-            _tree = _rf.Get("Events")
-            self._n_entries += _tree.GetEntries()
+        # The index also counts the events available
+        self._index.clear()
+        self._file_first = [0]
+        if _file_list.size() > 0:
+            if not self._index.open(_file_list, self.indexPath(self._file_list)):
+                # Without the index, count the entries of each file so
+                # events can still be reached by entry, but not by run and event
+                print("ERROR: could not index the files, run and event lookup is disabled")
+                for _f in self._file_list:
+                    _rf = ROOT.TFile(_f)
+                    _tree = _rf.Get("Events")
+                    _n = _tree.GetEntries() if _tree else 0
+                    self._file_first.append(self._file_first[-1] + _n)
+        if self._index.n_files() > 0:
+            self._n_entries = self._index.n_entries()
+        else:
+            self._n_entries = self._file_first[-1]
 
         # Create an instance of the data manager:
+        self._file = -1
         if _file_list.size() > 0:
             self._data_manager = gallery.Event(_file_list)
+            self._file = 0
 
 
         # Open the manager
@@ -250,6 +318,27 @@ class evd_manager_base(manager, QtCore.QObject):
         self.goToEvent(0)
         self.fileChanged.emit()
 
+    def indexPath(self, files):
+        # Next to the first file, one index per list of files, in the
+        # user's cache if that directory can not be written
+        key = zlib.crc32("\n".join(files).encode()) & 0xffffffff
+        name = ".evd_index_{:08x}".format(key)
+        directory = os.path.dirname(files[0])
+        if os.access(directory, os.W_OK):
+            return os.path.join(directory, name)
+        directory = os.path.join(os.path.expanduser("~"), ".evd_index")
+        try:
+            if not os.path.isdir(directory):
+                os.makedirs(directory)
+        except OSError:
+            # Not saved at all, the index is built on every open
+            return ""
+        return os.path.join(directory, name)
+
+    def productCachePath(self):
+        # Shared by every file list, the sidecars are named by file GUID
+        return os.path.join(os.path.expanduser("~"), ".evd_products")
+
     def getStages(self):
         return self._keyTable.keys()
 
@@ -286,6 +375,15 @@ class evd_manager_base(manager, QtCore.QObject):
     def internalEvent(self):
         return self._event
 
+    def setConcurrent(self, concurrent=True):
+        self._processer.set_concurrent(concurrent)
+
+    def setProfile(self, profile=True):
+        self._processer.set_profile(profile)
+
+    def profiler(self):
+        return self._processer.profiler()
+
     # override the functions from manager as needed here
     def next(self):
         # print "Called next"
@@ -308,27 +406,26 @@ class evd_manager_base(manager, QtCore.QObject):
             self._lastProcessed = self._event
 
     def goToEvent(self, event, force=False):
-        # Gallery events don't offer random access
-        
-
-        # Loop through until the event is gotten:
-        if event < self._n_entries:
-            if event == self._event + 1:
-                self._data_manager.next()
-
-            else:
-                if event > self._event:
-                    while event != self._data_manager.eventEntry():
-                        self._data_manager.next()
-                else:
-                    self._data_manager.toBegin()
-                    while event != self._data_manager.eventEntry():
-                        self._data_manager.next()
-        else:
+        # event counts the entries of all the files back to back
+        if event >= self._n_entries:
             print("Selected event is too high")
             return
+        if event < 0:
+            print("Selected event is negative")
+            return
+
+        # goToEntry only moves within a file, start a new
+        # data manager at the file of the event if it is in another
+        _file, _entry = self.locate(event)
+        if _file != self._file:
+            _file_list = ROOT.vector(ROOT.string)()
+            for _f in self._file_list[_file:]:
+                _file_list.push_back(_f)
+            self._data_manager = gallery.Event(_file_list)
+            self._file = _file
+        self._data_manager.goToEntry(_entry)
 
-        self.setEvent(self._data_manager.eventEntry())
+        self.setEvent(event)
         self.processEvent()
 
         # if self._view_manager != None:
@@ -336,6 +433,31 @@ class evd_manager_base(manager, QtCore.QObject):
         self.drawFresh()
         self.eventChanged.emit()
 
+    def locate(self, event):
+        # File and entry in that file of an entry of all the files
+        if self._index.n_files() > 0:
+            location = self._index.locate(event)
+            return location.file, location.entry
+        _file = bisect.bisect_right(self._file_first, event) - 1
+        return _file, event - self._file_first[_file]
+
+    def goToRunEvent(self, run, event, subrun=None):
+        # Without a subrun, the first subrun of the run with that event
+        if subrun is None:
+            entry = self._index.find(run, event)
+        else:
+            entry = self._index.find(run, subrun, event)
+        if entry < 0:
+            print("ERROR: run {} event {} is not in the files".format(run, event))
+            return
+        self.goToEvent(entry)
+
+    def loadSummary(self, path):
+        # The tree of evd::EventSummary (summarize_events), one numpy
+        # array per branch
+        frame = ROOT.RDataFrame("eventsummary", path)
+        return {str(name): column for name, column in frame.AsNumpy().items()}
+
 
 
 class evd_manager_2D(evd_manager_base):
@@ -486,8 +608,8 @@ class evd_manager_2D(evd_manager_base):
         self.filterNoise = filterBool
         if 'raw::RawDigit' in self._processer._ana_units.keys():
             self._wireDrawer.toggleNoiseFilter(self.filterNoise)
-            # Rerun the event just for the raw digits:
-            self.processEvent(force=True)
+            # The raw digit drawer keeps the raw and filtered planes of the
+            # event, so there is no need to process the event again:
             self.drawFresh()
 
     def getPlane(self, plane):
@@ -506,7 +628,7 @@ class evd_manager_2D(evd_manager_base):
         else:
             # Get the hits:
             hits = self._drawnClasses['Hit'].getHitsOnWire(plane, wire)
-            self._view_manager.drawHitsOnPlot(hits)
+            self._view_manager.drawHitsOnPlot(hits, plane)
 
 try:
     import pyqtgraph.opengl as gl
@@ -1,6 +1,6 @@
 
 
-import sys, signal
+import sys, signal, os
 import argparse
 # import collections
 from pyqtgraph.Qt import QtGui, QtCore
@@ -218,14 +218,17 @@ class view_manager(QtCore.QObject):
       #   self._wirePlotItem.setData(axisData,wireData)
       # else:
 
-  def drawHitsOnPlot(self,hits):
+  def drawHitsOnPlot(self,hits,plane):
     if not self._wireDrawer.isVisible():
       return
-    offset = self._geometry.timeOffsetTicks(hits[0].plane())
-    for i in range(len(hits)):
-      hit = hits[i]
-      xPts = np.linspace(hit.start_time() + offset, hit.end_time() + offset, hit.end_time() - hit.start_time() + 1)
-      yPts = hit.peak_amplitude() * np.exp( - 0.5 * (xPts - (hit.peak_time() + offset))**2 / hit.rms()**2  )
+    if hits is None:
+      return
+    offset = self._geometry.timeOffsetTicks(plane)
+    for i in range(len(hits['wire'])):
+      start_time = hits['start_time'][i]
+      end_time = hits['end_time'][i]
+      xPts = np.linspace(start_time + offset, end_time + offset, int(end_time - start_time) + 1)
+      yPts = hits['peak_amplitude'][i] * np.exp( - 0.5 * (xPts - (hits['peak_time'][i] + offset))**2 / hits['rms'][i]**2  )
       # self._plottedHits.append(self._wirePlot.plot(xPts,yPts))
       self._plottedHits.append(self._wirePlot.plot(xPts,yPts,pen=pg.mkPen((255,0,0,200),width=2)))
 
@@ -292,7 +295,8 @@ class gui(QtGui.QWidget):
     # This is a box to allow users to enter an event (larlite numbering)
     self._goToLabel = QtGui.QLabel("Go to: ")
     self._larliteEventEntry = QtGui.QLineEdit()
-    self._larliteEventEntry.setToolTip("Enter an event to skip to that event (larlite numbering")
+    self._larliteEventEntry.setToolTip("Enter an event to skip to that event (larlite numbering),\n"
+                                       "or run:event or run:subrun:event")
     self._larliteEventEntry.returnPressed.connect(self.goToEventWorker)
     # These labels display current events
     self._runLabel = QtGui.QLabel("Run: 0")
@@ -311,6 +315,11 @@ class gui(QtGui.QWidget):
     # Select a file to use
     self._fileSelectButton = QtGui.QPushButton("Select File")
     self._fileSelectButton.clicked.connect(self._event_manager.selectFile)
+    # Pick an event from a summary of the files
+    self._eventListButton = QtGui.QPushButton("Event List")
+    self._eventListButton.clicked.connect(self.eventListWorker)
+    self._eventListButton.setToolTip("Open an event summary (summarize_events) as a sortable list,\n"
+                                     "double click an event to go to it.")
     
     # pack the buttons into a box
     self._eventControlBox = QtGui.QVBoxLayout()
@@ -331,6 +340,7 @@ class gui(QtGui.QWidget):
     self._eventControlBox.addWidget(self._nextButton)
     self._eventControlBox.addWidget(self._prevButton)
     self._eventControlBox.addWidget(self._fileSelectButton)
+    self._eventControlBox.addWidget(self._eventListButton)
 
     return self._eventControlBox
   
@@ -339,12 +349,64 @@ class gui(QtGui.QWidget):
   def goToEventWorker(self):
     print("called goToEventWorker")
     try:
-      event = int(self._larliteEventEntry.text())
+      ids = [int(i) for i in str(self._larliteEventEntry.text()).split(":")]
+      if len(ids) > 3:
+        raise ValueError()
     except:
-      print("Error, must enter an integer")
+      print("Error, must enter an integer, run:event or run:subrun:event")
       self._larliteEventEntry.setText(str(self._event_manager.event()))
       return
-    self._event_manager.goToEvent(event)
+    if len(ids) == 1:
+      self._event_manager.goToEvent(ids[0])
+    elif len(ids) == 2:
+      self._event_manager.goToRunEvent(ids[0], ids[1])
+    else:
+      self._event_manager.goToRunEvent(ids[0], ids[2], subrun=ids[1])
+
+  # Show an event summary as a table, sorted by clicking a column header
+  def eventListWorker(self):
+    dialog = QtGui.QFileDialog()
+    f = dialog.getOpenFileName(self, "Open Event Summary", "",
+        "ROOT (*.root);;All Files (*)")
+    if pg.Qt.QT_LIB != pg.Qt.PYQT4:
+      f = f[0]
+    if not f:
+      return
+
+    try:
+      summary = self._event_manager.loadSummary(str(f))
+    except Exception as e:
+      print("ERROR: can not read an event summary from {}: {}".format(f, e))
+      return
+
+    first = ['run', 'subrun', 'event']
+    names = first + sorted(name for name in summary if name not in first)
+    n_events = len(summary['run'])
+
+    table = QtGui.QTableWidget(n_events, len(names))
+    table.setHorizontalHeaderLabels(names)
+    table.setEditTriggers(QtGui.QAbstractItemView.NoEditTriggers)
+    table.setSelectionBehavior(QtGui.QAbstractItemView.SelectRows)
+    for column, name in enumerate(names):
+      for row, value in enumerate(summary[name].tolist()):
+        # Numbers as data, so that they sort as numbers
+        item = QtGui.QTableWidgetItem()
+        item.setData(QtCore.Qt.DisplayRole, value)
+        table.setItem(row, column, item)
+    table.setSortingEnabled(True)
+
+    def goToRow(row, column):
+      ids = [int(table.item(row, c).data(QtCore.Qt.DisplayRole)) for c in range(3)]
+      self._event_manager.goToRunEvent(ids[0], ids[2], subrun=ids[1])
+    table.cellDoubleClicked.connect(goToRow)
+
+    self._eventList = QtGui.QDialog(self)
+    self._eventList.setWindowTitle("Events of " + os.path.basename(str(f)))
+    layout = QtGui.QVBoxLayout()
+    layout.addWidget(table)
+    self._eventList.setLayout(layout)
+    self._eventList.resize(800, 600)
+    self._eventList.show()
 
   # This function prepares the range controlling options and returns a layout
   def getDrawingControlButtons(self):
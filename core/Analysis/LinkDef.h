@@ -12,6 +12,12 @@
 #pragma link C++ class galleryfmwk::anabase+;
 #pragma link C++ class std::vector<galleryfmwk::anabase*>+;
 #pragma link C++ class galleryfmwk::anaprocessor+;
+#pragma link C++ class galleryfmwk::anascheduler+;
+#pragma link C++ class galleryfmwk::anaprofiler+;
+#pragma link C++ class galleryfmwk::anaprofiler::stats_t+;
+#pragma link C++ class galleryfmwk::eventindex+;
+#pragma link C++ class galleryfmwk::eventindex::location_t+;
+#pragma link C++ class galleryfmwk::productcache+;
 //ADD_NEW_CLASS ... do not change this line
 #endif
 
@@ -16,6 +16,9 @@
 #define GALLERY_FMWK_ANABASE_H
 
 
+#include <string>
+#include <vector>
+
 #include "gallery/Event.h"
 #include "Base/messenger.h"
 #include "TFile.h"
@@ -66,6 +69,42 @@ namespace galleryfmwk {
     
     /// Finalize method to be called after all events processed.
     virtual bool finalize(){return true;}
+
+    /**
+       A new instance configured like this one, for one worker of a parallel
+       anaprocessor run.  The worker initializes it, runs it on its share of
+       the events and hands it to merge() of this instance, it is never
+       finalized.  Returning 0 (the default) makes anaprocessor run serially.
+    */
+    virtual anabase* clone() const {return 0;}
+
+    /// Add the results of a clone made by clone(), before finalize
+    virtual bool merge(const anabase& /*worker*/){return true;}
+
+    /**
+       Return true if the merged results must follow the event order.  Each
+       worker then reads one contiguous block of entries and the clones are
+       merged in the order of their blocks.  Otherwise workers take small
+       chunks of entries as they become free, which balances the load better.
+    */
+    virtual bool ordered() const {return false;}
+
+    /**
+       What analyze uses besides the members of this instance, for
+       anascheduler: the products it reads ("type:label") and the shared
+       objects it fills.  Modules with a name in common never run at the
+       same time.  An empty list (the default) means run alone.
+    */
+    virtual std::vector<std::string> resources() const {return std::vector<std::string>();}
+
+    /**
+       Read every product that analyze will use.  anascheduler calls it on
+       one module at a time before the concurrent analyze calls, since
+       gallery reads are not thread safe.  anaprocessor's read ahead calls it
+       on a reader thread, on events ahead of the one being analyzed, so it
+       must not change the members of this instance.
+    */
+    virtual bool prefetch(gallery::Event * event){return event;}
     
     /// A setter for analysis output file poitner
     void set_output_file(TFile* fout){_fout=fout;}
@@ -3,8 +3,233 @@
 
 #include "anaprocessor.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "TROOT.h"
+
 namespace galleryfmwk {
 
+namespace {
+
+/// Goes to any entry of a list of files, entries counted over all the files back to back
+class anaseeker {
+
+public:
+
+  anaseeker(const std::vector<std::string> & files, const std::vector<long long> & file_first)
+    : _files(&files), _file_first(&file_first), _file(0) {}
+
+  gallery::Event* go_to(long long entry)
+  {
+    size_t f = std::upper_bound(_file_first->begin(), _file_first->end(), entry) - _file_first->begin() - 1;
+    if (!_event || f != _file) {
+      _event.reset(new gallery::Event(std::vector<std::string>(1, (*_files)[f])));
+      _file = f;
+    }
+    _event->goToEntry(entry - (*_file_first)[f]);
+    return _event.get();
+  }
+
+private:
+
+  const std::vector<std::string> * _files;
+  const std::vector<long long> * _file_first;
+
+  std::unique_ptr<gallery::Event> _event;
+  size_t _file;  ///< Index of the file _event reads
+};
+
+/// Entry k of a run, the k-th of the entry list if there is one
+inline long long entry_at(const std::vector<long long> & entry_list, long long k)
+{
+  return entry_list.empty() ? k : entry_list[k];
+}
+
+/// One thread of a parallel run: its own event reader and analysis modules
+struct anaworker {
+
+  std::vector<anabase*> analyzers; ///< Clones of the analysis modules
+  std::vector<bool> ana_status;    ///< Status of each clone after its last event
+  unsigned int nevents;            ///< Number of events processed
+  std::string error;               ///< Set if the worker stopped on an exception
+
+  std::vector<const anabase*> originals; ///< The modules the clones were made from
+  anaprofiler* profiler;           ///< Records the calls under the originals, or 0
+
+  const std::vector<bool> * filter; ///< Filter modules, 0 if the filters do not go first
+  std::vector<long long> selected; ///< Entries that passed the filters
+
+  anaseeker seeker;
+  size_t last_run_id;
+  size_t last_subrun_id;
+
+  anaworker(const std::vector<std::string> & files, const std::vector<long long> & file_first)
+    : nevents(0), profiler(0), filter(0), seeker(files, file_first),
+      last_run_id(-1), last_subrun_id(-1) {}
+  ~anaworker() {for (auto ana : analyzers) delete ana;}
+
+  /// Process entries [begin, end) of the run, see entry_at
+  void process(const std::vector<long long> & entry_list, long long begin, long long end)
+  {
+    for (long long k = begin; k < end; ++k) {
+
+      long long entry = entry_at(entry_list, k);
+      gallery::Event* event = seeker.go_to(entry);
+
+      // Same run and sub-run calls as anaprocessor::process_event
+      if (event->eventAuxiliary().run() != last_run_id) {
+        for (size_t i = 0; i < analyzers.size(); ++i) {
+          {
+            anaprofiler::timer timer(profiler, originals[i], anaprofiler::kBEGIN_RUN);
+            analyzers[i]->begin_run(event);
+          }
+          anaprofiler::timer timer(profiler, originals[i], anaprofiler::kBEGIN_SUBRUN);
+          analyzers[i]->begin_subrun(event);
+        }
+        last_run_id = event->eventAuxiliary().run();
+      }
+      else if (event->eventAuxiliary().subRun() != last_subrun_id) {
+        for (size_t i = 0; i < analyzers.size(); ++i) {
+          anaprofiler::timer timer(profiler, originals[i], anaprofiler::kBEGIN_SUBRUN);
+          analyzers[i]->begin_subrun(event);
+        }
+        last_subrun_id = event->eventAuxiliary().subRun();
+      }
+
+      // Same filters first as anaprocessor::process_event
+      bool pass = true;
+      for (size_t i = 0; filter && pass && i < analyzers.size(); ++i) {
+        if (!(*filter)[i]) continue;
+        anaprofiler::timer timer(profiler, originals[i], anaprofiler::kANALYZE);
+        pass = ana_status[i] = analyzers[i]->analyze(event);
+      }
+      if (filter && pass) selected.push_back(entry);
+
+      for (size_t i = 0; pass && i < analyzers.size(); ++i) {
+        if (filter && (*filter)[i]) continue;
+        {
+          anaprofiler::timer timer(profiler, originals[i], anaprofiler::kANALYZE);
+          ana_status[i] = analyzers[i]->analyze(event);
+        }
+        if (!ana_status[i]) break;
+      }
+
+      nevents++;
+    }
+  }
+};
+
+/**
+   Reads events on its own thread, at most depth events ahead of the one
+   handed out last.  Each event is read into one of depth + 1 slots, each
+   with its own gallery::Event, and the modules' prefetch is called on it.
+*/
+class anareader {
+
+public:
+
+  anareader(const std::vector<std::string> & files,
+            const std::vector<long long> & file_first,
+            const std::vector<long long> & entry_list,
+            long long n_entries, unsigned int depth,
+            const std::vector<anabase*> & analyzers)
+    : _entry_list(entry_list), _n_entries(n_entries), _analyzers(analyzers),
+      _events(depth + 1, 0), _read(0), _done(-1), _stop(false)
+  {
+    for (unsigned int slot = 0; slot <= depth; ++slot)
+      _slots.emplace_back(new anaseeker(files, file_first));
+    _thread = std::thread(&anareader::read, this);
+  }
+
+  ~anareader()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _changed.notify_all();
+    _thread.join();
+  }
+
+  /// The next event and its entry, 0 at the end.  The previous one is given back to the reader
+  gallery::Event* next(long long & entry)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    ++_done;
+    _changed.notify_all();
+    _changed.wait(lock, [this]() {return _read > _done || _read == _n_entries || !_error.empty();});
+    if (_read <= _done) return 0;
+    entry = entry_at(_entry_list, _done);
+    return _events[_done % _slots.size()];
+  }
+
+  /// Set if the reader stopped on an exception
+  std::string error()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _error;
+  }
+
+private:
+
+  void read()
+  {
+    try {
+      for (long long k = 0; k < _n_entries; ++k) {
+
+        // Wait for the slot, it is free once k - depth - 1 is done
+        {
+          std::unique_lock<std::mutex> lock(_mutex);
+          _changed.wait(lock, [&]() {return _stop || k - _done < (long long) _slots.size();});
+          if (_stop) return;
+        }
+
+        size_t slot = k % _slots.size();
+        gallery::Event* event = _slots[slot]->go_to(entry_at(_entry_list, k));
+        for (auto ana : _analyzers) ana->prefetch(event);
+
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          _events[slot] = event;
+          _read = k + 1;
+        }
+        _changed.notify_all();
+      }
+    }
+    catch (const std::exception & e) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _error = e.what();
+      }
+      _changed.notify_all();
+    }
+  }
+
+  const std::vector<long long> & _entry_list;
+  long long _n_entries;
+  std::vector<anabase*> _analyzers;
+
+  std::vector<std::unique_ptr<anaseeker> > _slots;
+  std::vector<gallery::Event*> _events; ///< Event in each slot
+  long long _read;    ///< Entries [0, _read) of the run are read
+  long long _done;    ///< Entry of the run handed out last, the ones before are done
+  bool _stop;
+  std::string _error;
+
+  std::mutex _mutex;
+  std::condition_variable _changed;
+  std::thread _thread;
+};
+
+}
+
 anaprocessor::anaprocessor() {
   _ofile_name = "";
   _event = nullptr;
@@ -13,6 +238,12 @@ anaprocessor::anaprocessor() {
   reset();
   _filter_enable = false;
   _ana_unit_status = true;
+  _n_threads = 1;
+  _read_ahead = 0;
+  _concurrent = false;
+  _profile = false;
+  _profile_tree = false;
+  _entry = -1;
 }
 
 
@@ -35,6 +266,7 @@ void anaprocessor::reset() {
 
   _analyzers.clear();
   _ana_status.clear();
+  _filter_marker_v.clear();
   _ana_index.clear();
   _nevents = 0;
   _index = 0;
@@ -74,6 +306,10 @@ bool anaprocessor::initialize() {
 
     _fout = TFile::Open(_ofile_name.c_str(), "RECREATE");
 
+  _profiler.clear();
+  if (_profile && _profile_tree && _fout)
+    _profiler.book_tree(_fout);
+
 
   bool status = true;
 
@@ -83,7 +319,10 @@ bool anaprocessor::initialize() {
 
     _analyzers[i]->set_output_file(_fout);
 
-    _ana_status[i] = _analyzers[i]->initialize();
+    {
+      anaprofiler::timer timer(profiler(), _analyzers[i], anaprofiler::kINITIALIZE);
+      _ana_status[i] = _analyzers[i]->initialize();
+    }
 
     if (!_ana_status[i]) {
 
@@ -98,6 +337,7 @@ bool anaprocessor::initialize() {
   _process = kREADY;
   _index = 0;
   _nevents = 0;
+  _selected_entries.clear();
 
   return status;
 }
@@ -120,39 +360,75 @@ bool anaprocessor::process_event() {
 
     for (size_t i = 0; i < _analyzers.size(); ++i) {
       auto& au = _analyzers[i];
-      if (_process != kPROCESSING) {
+      {
+        anaprofiler::timer timer(profiler(), au, anaprofiler::kBEGIN_RUN);
         au->begin_run(_event);
-        au->begin_subrun(_event);
-      } else {
-        au->begin_run(_event);
-        au->begin_subrun(_event);
       }
+      anaprofiler::timer timer(profiler(), au, anaprofiler::kBEGIN_SUBRUN);
+      au->begin_subrun(_event);
     }
     _last_run_id = _event->eventAuxiliary().run();
   } else if (_event->eventAuxiliary().subRun() != _last_subrun_id) {
 
     for (size_t i = 0; i < _analyzers.size(); ++i) {
       auto& au = _analyzers[i];
-      if (_process != kPROCESSING)
-        au->begin_subrun(_event);
-      else
-        au->begin_subrun(_event);
+      anaprofiler::timer timer(profiler(), au, anaprofiler::kBEGIN_SUBRUN);
+      au->begin_subrun(_event);
     }
     _last_subrun_id = _event->eventAuxiliary().subRun();
 
   }
 
-  for (size_t i = 0; i < _analyzers.size(); ++i) {
+  // Set by the run modes that know the entry of _event
+  long long entry = _entry >= 0 ? _entry : _index;
+  _entry = -1;
+
+  // Filters first, the other modules only see the events they all pass.
+  // A rejected event is not an error, the status of the others is kept.
+  bool pass = true;
+  for (size_t i = 0; _filter_enable && pass && i < _analyzers.size(); ++i) {
+    if (!_filter_marker_v[i]) continue;
+    anaprofiler::timer timer(profiler(), _analyzers[i], anaprofiler::kANALYZE);
+    pass = _ana_status[i] = _analyzers[i]->analyze(_event);
+  }
+  if (_filter_enable && pass) _selected_entries.push_back(entry);
+  _ana_unit_status = pass;
+
+  if (pass && _concurrent) {
+
+    std::vector<size_t> scheduled;
+    _scheduler.clear();
+    for (size_t i = 0; i < _analyzers.size(); ++i) {
+      if (_filter_enable && _filter_marker_v[i]) continue;
+      _scheduler.add_process(_analyzers[i]);
+      scheduled.push_back(i);
+    }
+    _scheduler.set_profiler(profiler());
 
-    _ana_status[i] = false;
+    _ana_unit_status = _scheduler.process_event(_event);
+    for (size_t k = 0; k < scheduled.size(); ++k)
+      _ana_status[scheduled[k]] = _scheduler.get_ana_status()[k];
 
-    _ana_status[i] = _analyzers[i]->analyze(_event);
+  }
+  else if (pass) {
+
+    for (size_t i = 0; i < _analyzers.size(); ++i) {
+
+      if (_filter_enable && _filter_marker_v[i]) continue;
+
+      _ana_status[i] = false;
 
-    _ana_unit_status = _ana_unit_status && _ana_status[i];
+      {
+        anaprofiler::timer timer(profiler(), _analyzers[i], anaprofiler::kANALYZE);
+        _ana_status[i] = _analyzers[i]->analyze(_event);
+      }
+
+      _ana_unit_status = _ana_unit_status && _ana_status[i];
 
-    if (!_ana_unit_status) break;
+      if (!_ana_unit_status) break;
 
 
+    }
   }
 
   _index++;
@@ -180,6 +456,25 @@ bool anaprocessor::run(unsigned int nevents) {
     return false;
   }
 
+  if (_n_threads > 1) {
+    bool clonable = true;
+    for (auto ana : _analyzers) {
+      anabase* copy = ana->clone();
+      if (!copy) {
+        Message::send(__FUNCTION__,
+                      Form("%s can not be cloned, running with one thread.", ana->name().c_str()));
+        clonable = false;
+        break;
+      }
+      delete copy;
+    }
+    if (clonable) return run_parallel(nevents);
+  }
+
+  if (_read_ahead) return run_read_ahead(nevents);
+
+  if (!_entry_list.empty()) return run_entries(nevents);
+
   char _buf[200];
   sprintf(_buf, "Processing %d events from entry %d...", nevents, 0);
   Message::send(__FUNCTION__, _buf);
@@ -228,6 +523,236 @@ bool anaprocessor::run(unsigned int nevents) {
 
 }
 
+std::vector<long long> anaprocessor::file_first_entries() const {
+
+  std::vector<long long> file_first(1, 0);
+  for (auto const & file : _input_files) {
+    gallery::Event counter(std::vector<std::string>(1, file));
+    file_first.push_back(file_first.back() + counter.numberOfEventsInFile());
+  }
+  return file_first;
+}
+
+bool anaprocessor::check_entry_list(long long n_entries) const {
+
+  for (auto entry : _entry_list) {
+    if (entry < 0 || entry >= n_entries) {
+      Message::send(__PRETTY_FUNCTION__,
+                    Form("Entry %lld of the entry list is not in the %lld entries of the files.",
+                         entry, n_entries));
+      return false;
+    }
+  }
+  return true;
+}
+
+bool anaprocessor::save_selected_entries(const std::string & path) const {
+
+  std::ofstream out(path.c_str());
+  for (auto entry : _selected_entries) out << entry << "\n";
+
+  if (!out) {
+    Message::send(__PRETTY_FUNCTION__, Form("Failed to write %s", path.c_str()));
+    return false;
+  }
+  return true;
+}
+
+bool anaprocessor::load_entry_list(const std::string & path) {
+
+  std::ifstream in(path.c_str());
+  if (!in) {
+    Message::send(__PRETTY_FUNCTION__, Form("Failed to open %s", path.c_str()));
+    return false;
+  }
+
+  std::vector<long long> entries;
+  long long entry;
+  while (in >> entry) entries.push_back(entry);
+  if (!in.eof()) {
+    Message::send(__PRETTY_FUNCTION__, Form("%s is not a list of entries", path.c_str()));
+    return false;
+  }
+
+  _entry_list = entries;
+  return true;
+}
+
+bool anaprocessor::run_entries(unsigned int nevents) {
+
+  std::vector<long long> file_first = file_first_entries();
+  if (!check_entry_list(file_first.back())) {
+    finalize();
+    return false;
+  }
+
+  long long n_entries = _entry_list.size();
+  if (nevents && nevents < n_entries) n_entries = nevents;
+
+  Message::send(__FUNCTION__,
+                Form("Processing %lld events of the entry list...", n_entries));
+
+  // process_event works on _event, point it to the events of the list
+  gallery::Event* own_event = _event;
+  anaseeker seeker(_input_files, file_first);
+
+  bool status = true;
+  for (long long k = 0; status && k < n_entries; ++k) {
+    _entry = _entry_list[k];
+    _event = seeker.go_to(_entry);
+    status = process_event();
+    if (_process != kPROCESSING) break;
+  }
+  _event = own_event;
+
+  Message::send(__FUNCTION__, Form("Processed %d events.", _nevents));
+
+  if (_process != kFINISHED)
+    status = finalize() && status;
+
+  return status;
+}
+
+bool anaprocessor::run_read_ahead(unsigned int nevents) {
+
+  std::vector<long long> file_first = file_first_entries();
+  if (!check_entry_list(file_first.back())) {
+    finalize();
+    return false;
+  }
+
+  long long n_entries = _entry_list.empty() ? file_first.back() : _entry_list.size();
+  if (nevents && nevents < n_entries) n_entries = nevents;
+
+  Message::send(__FUNCTION__,
+                Form("Processing %lld events, reading %u ahead...", n_entries, _read_ahead));
+
+  // gallery and ROOT I/O from two threads
+  ROOT::EnableThreadSafety();
+
+  // process_event works on _event, point it to the events of the reader
+  gallery::Event* own_event = _event;
+  bool status = true;
+  {
+    anareader reader(_input_files, file_first, _entry_list, n_entries, _read_ahead, _analyzers);
+
+    while (status && (_event = reader.next(_entry))) {
+      status = process_event();
+      if (_process != kPROCESSING) break;
+    }
+
+    if (!reader.error().empty()) {
+      Message::send(__PRETTY_FUNCTION__, Form("Reader stopped: %s", reader.error().c_str()));
+      status = false;
+    }
+  }
+  _event = own_event;
+
+  Message::send(__FUNCTION__, Form("Processed %d events.", _nevents));
+
+  if (_process != kFINISHED)
+    status = finalize() && status;
+
+  return status;
+}
+
+bool anaprocessor::run_parallel(unsigned int nevents) {
+
+  // Entry numbers over all the files back to back, file f starts at file_first[f]
+  std::vector<long long> file_first = file_first_entries();
+  if (!check_entry_list(file_first.back())) {
+    finalize();
+    return false;
+  }
+
+  long long n_entries = _entry_list.empty() ? file_first.back() : _entry_list.size();
+  if (nevents && nevents < n_entries) n_entries = nevents;
+
+  bool ordered = false;
+  for (auto ana : _analyzers) ordered = ordered || ana->ordered();
+
+  size_t n_workers = std::max(std::min((long long) _n_threads, n_entries), 1LL);
+
+  Message::send(__FUNCTION__,
+                Form("Processing %lld events with %zu threads%s...", n_entries, n_workers,
+                     ordered ? " in event order" : ""));
+
+  std::vector<std::unique_ptr<anaworker> > workers;
+  for (size_t w = 0; w < n_workers; ++w) {
+    workers.emplace_back(new anaworker(_input_files, file_first));
+    for (auto ana : _analyzers) {
+      workers[w]->analyzers.push_back(ana->clone());
+      workers[w]->analyzers.back()->set_output_file(0);
+      workers[w]->originals.push_back(ana);
+    }
+    workers[w]->profiler = profiler();
+    if (_filter_enable) workers[w]->filter = &_filter_marker_v;
+    workers[w]->ana_status.resize(_analyzers.size(), true);
+  }
+
+  // gallery and ROOT I/O from several threads
+  ROOT::EnableThreadSafety();
+
+  // Unordered runs hand out chunks of entries to whichever worker is free
+  long long chunk = std::max(n_entries / (long long) (16 * n_workers), 1LL);
+  std::atomic<long long> next_entry(0);
+
+  std::vector<std::thread> threads;
+  for (size_t w = 0; w < n_workers; ++w) {
+    threads.emplace_back([&, w]() {
+      anaworker & worker = *workers[w];
+      try {
+        for (size_t i = 0; i < worker.analyzers.size(); ++i) {
+          anaprofiler::timer timer(worker.profiler, worker.originals[i], anaprofiler::kINITIALIZE);
+          if (!worker.analyzers[i]->initialize())
+            throw std::runtime_error("Failed to initialize: " + worker.analyzers[i]->name());
+        }
+        if (ordered) {
+          worker.process(_entry_list, n_entries * w / n_workers, n_entries * (w + 1) / n_workers);
+        }
+        else {
+          long long begin;
+          while ((begin = next_entry.fetch_add(chunk)) < n_entries)
+            worker.process(_entry_list, begin, std::min(begin + chunk, n_entries));
+        }
+      }
+      catch (const std::exception & e) {
+        worker.error = e.what();
+      }
+    });
+  }
+  for (auto & thread : threads) thread.join();
+
+  // Merge in worker order, which is event order for ordered runs
+  bool status = true;
+  for (size_t w = 0; w < n_workers; ++w) {
+    anaworker & worker = *workers[w];
+    if (!worker.error.empty()) {
+      Message::send(__PRETTY_FUNCTION__, Form("Worker %zu stopped: %s", w, worker.error.c_str()));
+      status = false;
+    }
+    for (size_t i = 0; i < _analyzers.size(); ++i) {
+      if (!_analyzers[i]->merge(*worker.analyzers[i])) {
+        Message::send(__PRETTY_FUNCTION__,
+                      Form("Failed to merge: %s", _analyzers[i]->name().c_str()));
+        status = false;
+      }
+      _ana_status[i] = _ana_status[i] && worker.ana_status[i];
+    }
+    _nevents += worker.nevents;
+    _index += worker.nevents;
+    _selected_entries.insert(_selected_entries.end(), worker.selected.begin(), worker.selected.end());
+  }
+  if (!ordered) std::sort(_selected_entries.begin(), _selected_entries.end());
+
+  Message::send(__FUNCTION__, Form("Processed %d events.", _nevents));
+
+  _process = kPROCESSING;
+  status = finalize() && status;
+
+  return status;
+}
+
 bool anaprocessor::finalize() {
 
 
@@ -241,11 +766,21 @@ bool anaprocessor::finalize() {
 
   for (size_t i = 0; i < _analyzers.size(); ++i) {
 
-    _ana_status[i] = _analyzers[i]->finalize() && _ana_status[i];
+    bool finalized;
+    {
+      anaprofiler::timer timer(profiler(), _analyzers[i], anaprofiler::kFINALIZE);
+      finalized = _analyzers[i]->finalize();
+    }
+    // A filter rejecting the last event did not fail
+    bool filter = _filter_enable && _filter_marker_v[i];
+    _ana_status[i] = finalized && (_ana_status[i] || filter);
 
     status = status && _ana_status[i];
   }
 
+  // Before reset closes _fout
+  _profiler.write_tree();
+
   _process = kFINISHED;
   reset();
   return status;
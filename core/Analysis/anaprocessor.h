@@ -16,6 +16,8 @@
 
 #include <vector>
 #include "anabase.h"
+#include "anaprofiler.h"
+#include "anascheduler.h"
 #include "TFile.h"
 
 namespace galleryfmwk {
@@ -57,9 +59,61 @@ public:
   /// A method to run a batch process
   bool run(unsigned int nevents = 0);
 
+  /**
+     Number of threads used by run.  With more than one, each thread opens its
+     own gallery::Event and runs its own clones of the analysis modules (see
+     anabase::clone), then the clones are merged into the modules before
+     finalize.  If a module can not be cloned the run is serial.
+  */
+  void set_n_threads(unsigned int n) {_n_threads = n;}
+
+  /**
+     Number of events read ahead by run, 0 (the default) to read each event
+     when it is needed.  A reader thread opens its own gallery::Event, goes
+     to the next events and calls anabase::prefetch of every module on them,
+     while the modules analyze the current one.
+  */
+  void set_read_ahead(unsigned int depth) {_read_ahead = depth;}
+
+  /**
+     Run the analysis modules of each event concurrently where their
+     resources allow it (see anascheduler).  Every module then sees every
+     event, a module returning false does not stop the ones after it.
+  */
+  void set_concurrent(bool doit = true) {_concurrent = doit;}
+
+  /**
+     Measure the time and memory of every call of the analysis modules, see
+     anaprofiler.  With tree the calls are also written to the analysis
+     output file, as the TTree "anaprofiler".
+  */
+  void set_profile(bool doit = true, bool tree = false) {_profile = doit; _profile_tree = tree;}
+
+  /// Statistics of the analysis module calls of the last run, see set_profile
+  const anaprofiler& get_profiler() const {return _profiler;}
+
   /// A method to process just one event.
   bool process_event();
 
+  /**
+     Process only these entries, in this order.  Entries are counted over
+     all the input files back to back, the other entries are not read.  An
+     empty list (the default) processes every entry.
+  */
+  void set_entry_list(const std::vector<long long>& entries) {_entry_list = entries;}
+
+  /// set_entry_list from a file of entries, as written by save_selected_entries
+  bool load_entry_list(const std::string& path);
+
+  /**
+     Entries that passed every filter in the last run, see enable_filter, in
+     the order they were processed.  Runs with several threads sort them.
+  */
+  const std::vector<long long>& get_selected_entries() const {return _selected_entries;}
+
+  /// Write get_selected_entries to a text file, one entry per line
+  bool save_selected_entries(const std::string& path) const;
+
   /// A method to append analysis class instance. Returns index number.
   size_t add_process(anabase* ana, bool filter = false)
   {
@@ -77,7 +131,11 @@ public:
   /// A method to inquire the process status
   ProcessFlag_t get_process_status() {return _process;}
 
-  /// Setter to enable filtering mode
+  /**
+     Setter to enable filtering mode: the modules added as filters analyze
+     each event first, and the other modules only see the events that pass
+     all of them.  The entries that pass are kept, see get_selected_entries.
+  */
   void enable_filter(bool doit = true) { _filter_enable = doit; }
 
   /// A method to reset members
@@ -92,6 +150,24 @@ private:
   /// A method to finalize data processing
   bool finalize();
 
+  /// run with _n_threads workers over disjoint entry ranges
+  bool run_parallel(unsigned int nevents);
+
+  /// run with the events read by another thread, _read_ahead events ahead
+  bool run_read_ahead(unsigned int nevents);
+
+  /// run over the entries of _entry_list
+  bool run_entries(unsigned int nevents);
+
+  /// Check that the entries of _entry_list are in the input files
+  bool check_entry_list(long long n_entries) const;
+
+  /// First entry of each input file, entries of all files back to back, then the total
+  std::vector<long long> file_first_entries() const;
+
+  /// The profiler if profiling is on, 0 otherwise
+  anaprofiler* profiler() {return _profile ? &_profiler : 0;}
+
   std::vector<anabase*>   _analyzers;  ///< A vector of analysis modules
   std::vector<bool>        _ana_status; ///< A vector of analysis modules' status
   std::vector<bool>   _filter_marker_v; ///< A vector to mark specific analysis unit as a filter
@@ -108,6 +184,20 @@ private:
   bool _filter_enable;
   bool _ana_unit_status;
 
+  std::vector<long long> _entry_list;       ///< Entries to process, all if empty
+  std::vector<long long> _selected_entries; ///< Entries that passed the filters
+  long long _entry;          ///< Entry of _event if the run mode knows it, -1 otherwise
+
+  unsigned int _n_threads;   ///< Number of threads used by run
+  unsigned int _read_ahead;  ///< Number of events read ahead by run
+
+  bool _concurrent;          ///< Run the modules of an event concurrently
+  anascheduler _scheduler;
+
+  bool _profile;             ///< Measure the module calls
+  bool _profile_tree;        ///< Also write them to _fout
+  anaprofiler _profiler;
+
   std::string _name;             ///< class name holder
 
   size_t _last_run_id;
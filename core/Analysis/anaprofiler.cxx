@@ -0,0 +1,210 @@
+#ifndef GALLERY_FMWK_ANAPROFILER_CXX
+#define GALLERY_FMWK_ANAPROFILER_CXX
+
+#include "anaprofiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <utility>
+#include <sys/resource.h>
+
+#include "TString.h"
+
+namespace galleryfmwk {
+
+anaprofiler::anaprofiler(size_t window)
+  : _tree(0), _tree_stage(0), _tree_wall(0), _tree_cpu(0), _tree_memory(0)
+{
+  set_window(window);
+}
+
+anaprofiler::mark_t anaprofiler::start() const {
+
+  mark_t mark;
+
+  mark.wall = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+
+  timespec cpu;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+  mark.cpu = cpu.tv_sec * 1e3 + cpu.tv_nsec * 1e-6;
+
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef _CORE_Darwin_
+  mark.peak = usage.ru_maxrss / 1024.;  // bytes
+#else
+  mark.peak = usage.ru_maxrss;          // kB
+#endif
+
+  return mark;
+}
+
+void anaprofiler::stop(const anabase* ana, Stage_t stage, const mark_t& start) {
+
+  mark_t end = this->start();
+  float value[kQUANTITY_MAX];
+  value[kWALL] = end.wall - start.wall;
+  value[kCPU] = end.cpu - start.cpu;
+  value[kMEMORY] = end.peak - start.peak;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  auto iter = _modules.find(ana);
+  if (iter == _modules.end()) {
+    iter = _modules.insert(std::make_pair(ana, module_t())).first;
+    iter->second.name = ana->name();
+    iter->second.order = _modules.size() - 1;
+  }
+
+  series_t& series = iter->second.series[stage];
+  for (size_t q = 0; q < kQUANTITY_MAX; ++q) {
+    if (series.last[q].size() < _window)
+      series.last[q].push_back(value[q]);
+    else
+      series.last[q][series.next % series.last[q].size()] = value[q];
+  }
+  series.next = (series.next + 1) % _window;
+  series.n++;
+
+  if (_tree) {
+    _tree_module = iter->second.name;
+    _tree_stage = stage;
+    _tree_wall = value[kWALL];
+    _tree_cpu = value[kCPU];
+    _tree_memory = value[kMEMORY];
+    _tree->Fill();
+  }
+}
+
+void anaprofiler::book_tree(TDirectory* dir) {
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  _tree = new TTree("anaprofiler", "Time and memory of each analysis module call");
+  _tree->SetDirectory(dir);
+  _tree->Branch("module", &_tree_module);
+  _tree->Branch("stage", &_tree_stage, "stage/I");
+  _tree->Branch("wall", &_tree_wall, "wall/D");
+  _tree->Branch("cpu", &_tree_cpu, "cpu/D");
+  _tree->Branch("memory", &_tree_memory, "memory/D");
+}
+
+void anaprofiler::write_tree() {
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  if (!_tree) return;
+  _tree->GetDirectory()->cd();
+  _tree->Write();
+  _tree = 0;
+}
+
+void anaprofiler::clear() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  _modules.clear();
+}
+
+size_t anaprofiler::n_calls(const anabase* ana, Stage_t stage) const {
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  auto iter = _modules.find(ana);
+  if (iter == _modules.end()) return 0;
+  return iter->second.series[stage].n;
+}
+
+anaprofiler::stats_t anaprofiler::get_stats(const anabase* ana, Stage_t stage, Quantity_t quantity) const {
+
+  stats_t stats = {0, 0, 0, 0, 0};
+
+  std::vector<float> values;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto iter = _modules.find(ana);
+    if (iter == _modules.end()) return stats;
+    values = iter->second.series[stage].last[quantity];
+  }
+  if (values.empty()) return stats;
+
+  stats.n = values.size();
+  for (auto value : values) stats.mean += value;
+  stats.mean /= values.size();
+
+  // Nearest rank
+  auto rank = [&](double fraction) {
+    size_t k = std::min(values.size() - 1, (size_t) (fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+  };
+  stats.p50 = rank(0.50);
+  stats.p95 = rank(0.95);
+  stats.max = *std::max_element(values.begin(), values.end());
+
+  return stats;
+}
+
+const anabase* anaprofiler::find(const std::string& name) const {
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  const anabase* first = 0;
+  size_t order = _modules.size();
+  for (auto const & module : _modules) {
+    if (module.second.name == name && module.second.order < order) {
+      first = module.first;
+      order = module.second.order;
+    }
+  }
+  return first;
+}
+
+std::vector<const anabase*> anaprofiler::get_modules() const {
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  std::vector<const anabase*> modules(_modules.size());
+  for (auto const & module : _modules)
+    modules[module.second.order] = module.first;
+  return modules;
+}
+
+void anaprofiler::report(Stage_t stage) const {
+
+  Message::send(__FUNCTION__,
+                Form("%-24s %8s %10s %10s %10s %10s %10s",
+                     stage_name(stage).c_str(), "calls", "mean [ms]", "p50", "p95", "max", "cpu [ms]"));
+
+  // The modules may be gone, use the names recorded with them
+  std::vector<std::pair<const anabase*, std::string> > modules;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    modules.resize(_modules.size());
+    for (auto const & module : _modules)
+      modules[module.second.order] = std::make_pair(module.first, module.second.name);
+  }
+
+  for (auto const & module : modules) {
+    stats_t wall = wall_time(module.first, stage);
+    if (!wall.n) continue;
+    Message::send(__FUNCTION__,
+                  Form("%-24s %8zu %10.2f %10.2f %10.2f %10.2f %10.2f",
+                       module.second.c_str(), n_calls(module.first, stage),
+                       wall.mean, wall.p50, wall.p95, wall.max, cpu_time(module.first, stage).mean));
+  }
+}
+
+std::string anaprofiler::stage_name(Stage_t stage) {
+  switch (stage) {
+  case kINITIALIZE:   return "initialize";
+  case kBEGIN_RUN:    return "begin_run";
+  case kBEGIN_SUBRUN: return "begin_subrun";
+  case kANALYZE:      return "analyze";
+  case kFINALIZE:     return "finalize";
+  default:            return "";
+  }
+}
+
+}
+#endif
@@ -0,0 +1,182 @@
+/**
+ * \file anaprofiler.h
+ *
+ * \ingroup Analysis
+ *
+ * \brief Time and memory used by each call of the analysis modules
+ *
+ * @author cadams
+ */
+
+/** \addtogroup Analysis
+
+    @{*/
+#ifndef GALLERY_FMWK_ANAPROFILER_H
+#define GALLERY_FMWK_ANAPROFILER_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "anabase.h"
+#include "TDirectory.h"
+#include "TTree.h"
+
+namespace galleryfmwk {
+/**
+   \class anaprofiler
+   Records the wall time, the CPU time and the growth of the peak memory of
+   each call of an analysis module, and keeps statistics of the last calls.
+
+   A call is measured with start() before it and stop() after it.  The CPU
+   time is the one of the calling thread, so it is right for modules run on
+   other threads too.  The memory is the growth of the peak resident size of
+   the process during the call: it is zero unless the call reached a new
+   peak, and with modules running concurrently it goes to whichever module
+   was running at the time.
+*/
+class anaprofiler {
+
+public:
+
+  /// The analysis module calls that are measured
+  enum Stage_t {
+    kINITIALIZE,   ///< anabase::initialize
+    kBEGIN_RUN,    ///< anabase::begin_run
+    kBEGIN_SUBRUN, ///< anabase::begin_subrun
+    kANALYZE,      ///< anabase::analyze
+    kFINALIZE,     ///< anabase::finalize
+    kSTAGE_MAX
+  };
+
+  /// Clocks and peak memory at the start of a call, see start()
+  struct mark_t {
+    double wall;  ///< Wall time [ms]
+    double cpu;   ///< CPU time of the thread [ms]
+    double peak;  ///< Peak resident size of the process [kB]
+  };
+
+  /// Statistics of the last calls, see set_window
+  struct stats_t {
+    size_t n;      ///< Number of calls the statistics are made of
+    double mean;
+    double p50;
+    double p95;
+    double max;
+  };
+
+  /**
+     Records the call made during its lifetime, nothing if profiler is 0:
+     { anaprofiler::timer t(profiler, ana, anaprofiler::kANALYZE); ana->analyze(event); }
+  */
+  class timer {
+  public:
+    timer(anaprofiler* profiler, const anabase* ana, Stage_t stage)
+      : _profiler(profiler), _ana(ana), _stage(stage)
+    {if (_profiler) _start = _profiler->start();}
+    ~timer() {if (_profiler) _profiler->stop(_ana, _stage, _start);}
+  private:
+    anaprofiler* _profiler;
+    const anabase* _ana;
+    Stage_t _stage;
+    mark_t _start;
+  };
+
+  /// Default constructor, statistics of the last window calls
+  anaprofiler(size_t window = 1000);
+
+  /// Default destructor
+  virtual ~anaprofiler() {}
+
+  /// Number of calls of each module and stage the statistics are made of
+  void set_window(size_t window) {_window = window > 0 ? window : 1;}
+
+  /// Take the clocks before a call
+  mark_t start() const;
+
+  /// Record a call of ana that started at start
+  void stop(const anabase* ana, Stage_t stage, const mark_t& start);
+
+  /**
+   * @brief Also fill each call into a TTree
+   * @details The tree is called "anaprofiler" and has one entry per call:
+   *          module, stage, wall and cpu in ms, memory in kB.  It is owned by
+   *          dir, write_tree writes it.
+   */
+  void book_tree(TDirectory* dir);
+
+  /// Write the tree booked by book_tree and stop filling it
+  void write_tree();
+
+  /// Forget all the calls
+  void clear();
+
+  /// Number of calls recorded since the last clear
+  size_t n_calls(const anabase* ana, Stage_t stage) const;
+
+  /// Wall time of the last calls [ms]
+  stats_t wall_time(const anabase* ana, Stage_t stage) const {return get_stats(ana, stage, kWALL);}
+
+  /// CPU time of the last calls [ms]
+  stats_t cpu_time(const anabase* ana, Stage_t stage) const {return get_stats(ana, stage, kCPU);}
+
+  /// Growth of the peak resident size during the last calls [kB]
+  stats_t memory(const anabase* ana, Stage_t stage) const {return get_stats(ana, stage, kMEMORY);}
+
+  /// Same as above by module name, the first module recorded with that name
+  size_t n_calls(const std::string& name, Stage_t stage) const {return n_calls(find(name), stage);}
+  stats_t wall_time(const std::string& name, Stage_t stage) const {return wall_time(find(name), stage);}
+  stats_t cpu_time(const std::string& name, Stage_t stage) const {return cpu_time(find(name), stage);}
+  stats_t memory(const std::string& name, Stage_t stage) const {return memory(find(name), stage);}
+
+  /// The modules recorded, in the order of their first call
+  std::vector<const anabase*> get_modules() const;
+
+  /// Print the wall and CPU time of every module for this stage
+  void report(Stage_t stage = kANALYZE) const;
+
+  /// Name of a stage, as in the TTree
+  static std::string stage_name(Stage_t stage);
+
+private:
+
+  enum Quantity_t {kWALL, kCPU, kMEMORY, kQUANTITY_MAX};
+
+  /// Calls of one module in one stage
+  struct series_t {
+    size_t n;                   ///< Number of calls
+    size_t next;                ///< Index in last of the next call
+    std::vector<float> last[kQUANTITY_MAX]; ///< The last _window calls
+    series_t() : n(0), next(0) {}
+  };
+
+  struct module_t {
+    std::string name;
+    size_t order;
+    series_t series[kSTAGE_MAX];
+  };
+
+  stats_t get_stats(const anabase* ana, Stage_t stage, Quantity_t quantity) const;
+
+  const anabase* find(const std::string& name) const;
+
+  size_t _window;
+
+  std::map<const anabase*, module_t> _modules;
+
+  // Filled as the calls come, owned by its directory
+  TTree* _tree;
+  std::string _tree_module;
+  int _tree_stage;
+  double _tree_wall;
+  double _tree_cpu;
+  double _tree_memory;
+
+  // Modules may be run on several threads
+  mutable std::mutex _mutex; //!
+
+};
+}
+#endif
+
+/** @} */ // end of doxygen group
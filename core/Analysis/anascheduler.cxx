@@ -0,0 +1,98 @@
+#ifndef GALLERY_FMWK_ANASCHEDULER_CXX
+#define GALLERY_FMWK_ANASCHEDULER_CXX
+
+#include "anascheduler.h"
+
+#include <algorithm>
+#include <exception>
+#include <set>
+
+namespace galleryfmwk {
+
+size_t anascheduler::add_process(anabase* ana) {
+  _analyzers.push_back(ana);
+  _ana_status.push_back(false);
+  return _analyzers.size() - 1;
+}
+
+bool anascheduler::remove_process(anabase* ana) {
+  auto iter = std::find(_analyzers.begin(), _analyzers.end(), ana);
+  if (iter == _analyzers.end()) return false;
+  _ana_status.erase(_ana_status.begin() + (iter - _analyzers.begin()));
+  _analyzers.erase(iter);
+  return true;
+}
+
+void anascheduler::schedule() {
+
+  // Resources of each module, no resources means it runs alone
+  std::vector<std::set<std::string> > resources(_analyzers.size());
+  for (size_t i = 0; i < _analyzers.size(); ++i) {
+    std::vector<std::string> names = _analyzers[i]->resources();
+    resources[i].insert(names.begin(), names.end());
+  }
+
+  std::vector<size_t> stage_of(_analyzers.size(), 0);
+  _stages.clear();
+
+  for (size_t i = 0; i < _analyzers.size(); ++i) {
+
+    size_t stage = 0;
+    for (size_t j = 0; j < i; ++j) {
+      bool conflict = resources[i].empty() || resources[j].empty();
+      for (auto const & name : resources[i]) {
+        if (conflict) break;
+        conflict = resources[j].count(name);
+      }
+      if (conflict) stage = std::max(stage, stage_of[j] + 1);
+    }
+    stage_of[i] = stage;
+    if (_stages.size() <= stage) _stages.resize(stage + 1);
+    _stages[stage].push_back(i);
+  }
+}
+
+bool anascheduler::process_event(gallery::Event* event) {
+
+  // All the reading, one module at a time
+  for (auto ana : _analyzers) ana->prefetch(event);
+
+  schedule();
+
+  _ana_status.assign(_analyzers.size(), false);
+
+  // The pool only grows, the stages are the same from event to event
+  size_t width = 0;
+  for (auto const & stage : _stages) width = std::max(width, stage.size());
+  if (width > 0 && (!_pool || _pool->n_threads() < width))
+    _pool.reset(new threadpool(width));
+
+  for (auto const & stage : _stages) {
+
+    // vector<bool> is not safe to write from several threads
+    std::vector<char> status(stage.size(), 0);
+    std::vector<std::exception_ptr> errors(stage.size());
+
+    auto run = [&](int k, int) {
+      try {
+        anaprofiler::timer timer(_profiler, _analyzers[stage[k]], anaprofiler::kANALYZE);
+        status[k] = _analyzers[stage[k]]->analyze(event);
+      }
+      catch (...) {
+        errors[k] = std::current_exception();
+      }
+    };
+
+    _pool->run(stage.size(), run);
+
+    for (size_t k = 0; k < stage.size(); ++k) {
+      if (errors[k]) std::rethrow_exception(errors[k]);
+      _ana_status[stage[k]] = status[k];
+    }
+  }
+
+  return std::find(_ana_status.begin(), _ana_status.end(), false) == _ana_status.end();
+}
+
+}
+#endif
@@ -0,0 +1,89 @@
+/**
+ * \file anascheduler.h
+ *
+ * \ingroup Analysis
+ *
+ * \brief Runs the analysis modules of one event concurrently
+ *
+ * @author cadams
+ */
+
+/** \addtogroup Analysis
+
+    @{*/
+#ifndef GALLERY_FMWK_ANASCHEDULER_H
+#define GALLERY_FMWK_ANASCHEDULER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "Base/threadpool.h"
+#include "anabase.h"
+#include "anaprofiler.h"
+
+namespace galleryfmwk {
+/**
+   \class anascheduler
+   Calls analyze of every module on one event, running modules that share
+   no resource (see anabase::resources) at the same time.
+
+   The modules are split into stages: a module goes in the stage after the
+   last earlier module it shares a resource with, so modules that share a
+   resource run in the order they were added.  Before any analyze, prefetch
+   is called on every module, one at a time, so all the gallery reads are
+   done on the calling thread.  process_event returns when every module is
+   done.  The modules of a stage run on a threadpool kept between events,
+   as wide as the widest stage.
+*/
+class anascheduler {
+
+public:
+
+  /// Default constructor
+  anascheduler() : _profiler(0) {}
+
+  /// Default destructor
+  virtual ~anascheduler() {}
+
+  /// Append an analysis module, returns its index
+  size_t add_process(anabase* ana);
+
+  /// Remove an analysis module, returns false if it was not added
+  bool remove_process(anabase* ana);
+
+  /// Remove all the analysis modules
+  void clear() {_analyzers.clear(); _ana_status.clear();}
+
+  size_t size() const {return _analyzers.size();}
+
+  /// Record the analyze calls with this profiler, 0 to stop
+  void set_profiler(anaprofiler* profiler) {_profiler = profiler;}
+
+  /// Run prefetch and then analyze of every module on this event
+  bool process_event(gallery::Event* event);
+
+  /// Status returned by analyze of each module on the last event, in the order they were added
+  const std::vector<bool>& get_ana_status() const {return _ana_status;}
+
+  /// Indices of the modules run together, stage by stage, as of the last event
+  const std::vector<std::vector<size_t> >& get_stages() const {return _stages;}
+
+private:
+
+  /// Split the modules into stages from their current resources
+  void schedule();
+
+  std::vector<anabase*> _analyzers;
+  std::vector<bool> _ana_status;
+  std::vector<std::vector<size_t> > _stages;
+
+  anaprofiler* _profiler;
+
+  // Runs the modules of each stage, the calling thread is one of its threads
+  std::unique_ptr<threadpool> _pool; //!
+
+};
+}
+#endif
+
+/** @} */ // end of doxygen group
@@ -0,0 +1,154 @@
+//
+// Benchmark of anaprocessor::set_read_ahead on a list of files.
+//
+// The same analysis runs over the files once per read ahead depth, starting
+// with 0 (no read ahead).  It reads the recob::Wire of one producer and sums
+// every ROI of every wire a number of times, more passes give more analysis
+// time per event.
+//
+// For each depth the run time is printed along with the time spent in
+// analyze.  Without read ahead the rest of the run time is
+// mostly reading, with it the reading overlaps the analysis:
+//   overlap : fraction of the smaller of reading and analysis that was
+//             hidden, 1 when the run takes only as long as the larger one
+//
+// Usage:
+//   > bench_read_ahead producer passes depth[,depth...] file [file ...]
+//
+
+#include "Analysis/anaprocessor.h"
+
+#include "canvas/Utilities/InputTag.h"
+#include "lardataobj/RecoBase/Wire.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace galleryfmwk;
+
+class wire_sum : public anabase {
+
+public:
+
+  wire_sum(const std::string & producer, int passes)
+    : _producer(producer), _passes(passes), _sum(0), _events(0), _time(0)
+  {
+    _name = "wire_sum";
+  }
+
+  bool prefetch(gallery::Event * ev)
+  {
+    ev->getValidHandle<std::vector<recob::Wire> >(art::InputTag(_producer));
+    return true;
+  }
+
+  bool analyze(gallery::Event * ev)
+  {
+    // Only the analysis is timed, the reading is what the run adds to it
+    auto const & wires = ev->getValidHandle<std::vector<recob::Wire> >(art::InputTag(_producer));
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < _passes; pass++) {
+      for (auto const & wire : *wires) {
+        for (auto const & roi : wire.SignalROI().get_ranges()) {
+          for (auto adc : roi) _sum += adc * adc;
+        }
+      }
+    }
+    _time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    _events++;
+    return true;
+  }
+
+  double sum() const {return _sum;}
+
+  /// Number of events analyzed
+  size_t events() const {return _events;}
+
+  /// Time spent in analyze after reading the wires [s]
+  double time() const {return _time;}
+
+private:
+
+  std::string _producer;
+  int _passes;
+  double _sum;
+  size_t _events;
+  double _time;
+
+};
+
+int main(int argc, char ** argv)
+{
+  if (argc < 5) {
+    std::cerr << "Usage: " << argv[0] << " producer passes depth[,depth...] file [file ...]" << std::endl;
+    return 1;
+  }
+
+  std::string producer = argv[1];
+  int passes = std::atoi(argv[2]);
+
+  std::vector<unsigned int> depths(1, 0);
+  std::stringstream depth_list(argv[3]);
+  std::string depth;
+  while (std::getline(depth_list, depth, ','))
+    if (std::atoi(depth.c_str()) > 0) depths.push_back(std::atoi(depth.c_str()));
+
+  std::vector<std::string> files(argv + 4, argv + argc);
+
+  double serial_run = 0;
+  double serial_analyze = 0;
+  double serial_sum = 0;
+
+  std::cout << std::setw(6) << "depth"
+            << std::setw(10) << "events"
+            << std::setw(12) << "run [s]"
+            << std::setw(14) << "analyze [s]"
+            << std::setw(12) << "read [s]"
+            << std::setw(10) << "overlap" << std::endl;
+
+  for (auto d : depths) {
+
+    anaprocessor processor;
+    for (auto const & file : files) processor.add_input_file(file);
+    processor.set_read_ahead(d);
+
+    wire_sum analysis(producer, passes);
+    processor.add_process(&analysis);
+
+    auto start = std::chrono::steady_clock::now();
+    processor.run();
+    double run = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double analyze = analysis.time();
+
+    if (d == 0) {
+      serial_run = run;
+      serial_analyze = analyze;
+      serial_sum = analysis.sum();
+    }
+    else if (analysis.sum() != serial_sum) {
+      std::cerr << "ERROR: depth " << d << " gives a different result" << std::endl;
+      return 1;
+    }
+
+    // Reading is what the serial run does besides analyze
+    double read = serial_run - serial_analyze;
+    double hideable = std::min(read, serial_analyze);
+    double overlap = hideable > 0 ? (serial_run - run) / hideable : 0;
+
+    std::cout << std::setw(6) << d
+              << std::setw(10) << analysis.events()
+              << std::setw(12) << std::fixed << std::setprecision(3) << run
+              << std::setw(14) << analyze
+              << std::setw(12) << read
+              << std::setw(10) << std::setprecision(2) << overlap << std::endl;
+  }
+
+  return 0;
+}
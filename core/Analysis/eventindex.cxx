@@ -0,0 +1,263 @@
+#ifndef GALLERY_FMWK_EVENTINDEX_CXX
+#define GALLERY_FMWK_EVENTINDEX_CXX
+
+#include "eventindex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <sys/stat.h>
+
+#include "gallery/Event.h"
+#include "Base/messenger.h"
+#include "TROOT.h"
+#include "TString.h"
+
+namespace galleryfmwk {
+
+namespace {
+
+/// First line of a sidecar, change the number when the format changes
+const char* kSidecarVersion = "galleryfmwk::eventindex 1";
+
+}
+
+bool eventindex::stat(const std::string& path, file_t& file) {
+  struct stat buf;
+  if (::stat(path.c_str(), &buf) != 0) return false;
+  file.path = path;
+  file.size = buf.st_size;
+  file.mtime = buf.st_mtime;
+  return true;
+}
+
+void eventindex::clear() {
+  _files.clear();
+  _file_first.clear();
+  _locations.clear();
+  _by_run_event.clear();
+  _by_entry.clear();
+}
+
+bool eventindex::open(const std::vector<std::string>& files, const std::string& sidecar,
+                      unsigned int n_threads) {
+
+  if (!sidecar.empty() && load(files, sidecar)) return true;
+
+  if (!build(files, n_threads)) return false;
+
+  if (!sidecar.empty() && !save(sidecar))
+    Message::send(__FUNCTION__, Form("Could not save the index to %s", sidecar.c_str()));
+
+  return true;
+}
+
+bool eventindex::build(const std::vector<std::string>& files, unsigned int n_threads) {
+
+  clear();
+
+  _files.resize(files.size());
+  for (size_t f = 0; f < files.size(); ++f) {
+    if (!stat(files[f], _files[f])) {
+      Message::send(__PRETTY_FUNCTION__, Form("Can not read %s", files[f].c_str()));
+      clear();
+      return false;
+    }
+  }
+
+  if (!n_threads) n_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  n_threads = std::min<size_t>(n_threads, std::max<size_t>(files.size(), 1));
+
+  // gallery and ROOT I/O from several threads
+  if (n_threads > 1) ROOT::EnableThreadSafety();
+
+  // Each thread takes the next file, its events go in the list of that file
+  std::vector<std::vector<location_t> > by_file(files.size());
+  std::vector<std::string> errors(files.size());
+  std::atomic<size_t> next_file(0);
+
+  auto scan = [&]() {
+    size_t f;
+    while ((f = next_file++) < files.size()) {
+      try {
+        gallery::Event event(std::vector<std::string>(1, files[f]));
+        for (; !event.atEnd(); event.next()) {
+          auto const & aux = event.eventAuxiliary();
+          location_t location;
+          location.run = aux.run();
+          location.subrun = aux.subRun();
+          location.event = aux.event();
+          location.file = f;
+          location.entry = event.eventEntry();
+          by_file[f].push_back(location);
+        }
+      }
+      catch (const std::exception & e) {
+        errors[f] = e.what();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 1; t < n_threads; ++t) threads.emplace_back(scan);
+  scan();
+  for (auto & thread : threads) thread.join();
+
+  _file_first.assign(1, 0);
+  for (size_t f = 0; f < files.size(); ++f) {
+    if (!errors[f].empty()) {
+      Message::send(__PRETTY_FUNCTION__, Form("Failed to read %s: %s", files[f].c_str(), errors[f].c_str()));
+      clear();
+      return false;
+    }
+    _files[f].n_entries = by_file[f].size();
+    _file_first.push_back(_file_first.back() + by_file[f].size());
+    _locations.insert(_locations.end(), by_file[f].begin(), by_file[f].end());
+  }
+
+  sort();
+
+  return true;
+}
+
+bool eventindex::load(const std::vector<std::string>& files, const std::string& sidecar) {
+
+  clear();
+
+  std::ifstream in(sidecar.c_str());
+  if (!in) return false;
+
+  std::string version;
+  std::getline(in, version);
+  if (version != kSidecarVersion) return false;
+
+  size_t n_files;
+  in >> n_files;
+  if (!in || n_files != files.size()) return false;
+
+  // Stale if any file moved, changed or was replaced
+  _files.resize(n_files);
+  _file_first.assign(1, 0);
+  for (size_t f = 0; f < n_files; ++f) {
+    file_t now;
+    file_t & saved = _files[f];
+    in >> saved.size >> saved.mtime >> saved.n_entries >> std::ws;
+    std::getline(in, saved.path);
+    if (!in || saved.path != files[f] || !stat(files[f], now) ||
+        now.size != saved.size || now.mtime != saved.mtime) {
+      clear();
+      return false;
+    }
+    _file_first.push_back(_file_first.back() + saved.n_entries);
+  }
+
+  size_t n_locations;
+  in >> n_locations;
+  if (!in || (long long) n_locations != n_entries()) {
+    clear();
+    return false;
+  }
+
+  _locations.resize(n_locations);
+  for (auto & location : _locations) {
+    in >> location.run >> location.subrun >> location.event >> location.file >> location.entry;
+    if (location.file >= n_files || location.entry < 0 ||
+        location.entry >= _files[location.file].n_entries) {
+      in.setstate(std::ios::failbit);
+      break;
+    }
+  }
+  if (!in) {
+    clear();
+    return false;
+  }
+
+  sort();
+
+  return true;
+}
+
+bool eventindex::save(const std::string& sidecar) const {
+
+  // Write aside and rename, so a reader never sees half a file
+  std::string tmp = sidecar + ".tmp";
+  {
+    std::ofstream out(tmp.c_str());
+    if (!out) return false;
+
+    out << kSidecarVersion << "\n";
+    out << _files.size() << "\n";
+    for (auto const & file : _files)
+      out << file.size << " " << file.mtime << " " << file.n_entries << " " << file.path << "\n";
+
+    out << _locations.size() << "\n";
+    for (auto const & location : _locations)
+      out << location.run << " " << location.subrun << " " << location.event << " "
+          << location.file << " " << location.entry << "\n";
+
+    if (!out) return false;
+  }
+
+  return std::rename(tmp.c_str(), sidecar.c_str()) == 0;
+}
+
+void eventindex::sort() {
+
+  std::sort(_locations.begin(), _locations.end(),
+  [](const location_t & a, const location_t & b) {
+    return std::tie(a.run, a.subrun, a.event, a.file, a.entry) <
+           std::tie(b.run, b.subrun, b.event, b.file, b.entry);
+  });
+
+  _by_run_event.resize(_locations.size());
+  for (size_t i = 0; i < _by_run_event.size(); ++i) _by_run_event[i] = i;
+  std::stable_sort(_by_run_event.begin(), _by_run_event.end(),
+  [this](size_t a, size_t b) {
+    return std::tie(_locations[a].run, _locations[a].event) <
+           std::tie(_locations[b].run, _locations[b].event);
+  });
+
+  _by_entry.assign(n_entries(), 0);
+  for (size_t i = 0; i < _locations.size(); ++i)
+    _by_entry[_file_first[_locations[i].file] + _locations[i].entry] = i;
+}
+
+long long eventindex::find(unsigned int run, unsigned int subrun, unsigned int event) const {
+
+  location_t key = {run, subrun, event, 0, 0};
+  auto iter = std::lower_bound(_locations.begin(), _locations.end(), key,
+  [](const location_t & a, const location_t & b) {
+    return std::tie(a.run, a.subrun, a.event) < std::tie(b.run, b.subrun, b.event);
+  });
+
+  if (iter == _locations.end() || iter->run != run || iter->subrun != subrun || iter->event != event)
+    return -1;
+  return _file_first[iter->file] + iter->entry;
+}
+
+long long eventindex::find(unsigned int run, unsigned int event) const {
+
+  // Stable sort kept the (subrun, file, entry) order within a (run, event)
+  auto iter = std::lower_bound(_by_run_event.begin(), _by_run_event.end(), std::make_pair(run, event),
+  [this](size_t a, const std::pair<unsigned int, unsigned int> & b) {
+    return std::tie(_locations[a].run, _locations[a].event) < std::tie(b.first, b.second);
+  });
+
+  if (iter == _by_run_event.end() || _locations[*iter].run != run || _locations[*iter].event != event)
+    return -1;
+  return _file_first[_locations[*iter].file] + _locations[*iter].entry;
+}
+
+eventindex::location_t eventindex::locate(long long entry) const {
+  if (entry < 0 || entry >= n_entries())
+    throw std::out_of_range("eventindex::locate");
+  return _locations[_by_entry[entry]];
+}
+
+}
+#endif
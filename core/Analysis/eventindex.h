@@ -0,0 +1,132 @@
+/**
+ * \file eventindex.h
+ *
+ * \ingroup Analysis
+ *
+ * \brief Index from (run, subrun, event) to (file, entry) over a file list
+ *
+ * @author cadams
+ */
+
+/** \addtogroup Analysis
+
+    @{*/
+#ifndef GALLERY_FMWK_EVENTINDEX_H
+#define GALLERY_FMWK_EVENTINDEX_H
+
+#include <string>
+#include <vector>
+
+namespace galleryfmwk {
+/**
+   \class eventindex
+   Sorted (run, subrun, event) of every entry of a list of art files, with
+   the file and the entry in that file.  Finding an event is a binary search,
+   gallery::Event::goToEntry then goes to it.
+
+   The index is built by reading the EventAuxiliary of every entry, the files
+   are read in parallel.  It can be saved to a sidecar file and loaded back,
+   the sidecar records the size and modification time of every file and is
+   not loaded if any of them changed.
+*/
+class eventindex {
+
+public:
+
+  /// Where an event is
+  struct location_t {
+    unsigned int run;
+    unsigned int subrun;
+    unsigned int event;
+    unsigned int file;   ///< Index of the file in the list
+    long long entry;     ///< Entry in that file
+  };
+
+  /// Default constructor
+  eventindex() {}
+
+  /// Default destructor
+  virtual ~eventindex() {}
+
+  /**
+   * @brief Index of these files, from sidecar if it is up to date
+   * @details Otherwise the index is built and saved to sidecar.  An empty
+   *          sidecar only builds.
+   *
+   * @param files The input files, in the order they are read
+   * @param sidecar Path of the sidecar file
+   * @param n_threads Threads used to build, 0 for one per core
+   */
+  bool open(const std::vector<std::string>& files, const std::string& sidecar = "",
+            unsigned int n_threads = 0);
+
+  /// Read the EventAuxiliary of every entry of files
+  bool build(const std::vector<std::string>& files, unsigned int n_threads = 0);
+
+  /// Load from a sidecar file, false if it is not the index of files as they are now
+  bool load(const std::vector<std::string>& files, const std::string& sidecar);
+
+  /// Save to a sidecar file
+  bool save(const std::string& sidecar) const;
+
+  /// Forget the files
+  void clear();
+
+  /// Number of files
+  size_t n_files() const {return _files.size();}
+
+  /// Number of entries of all the files
+  long long n_entries() const {return _file_first.empty() ? 0 : _file_first.back();}
+
+  /// Entries of all the files back to back, the first entry of each file
+  long long file_first(size_t file) const {return _file_first.at(file);}
+
+  /**
+   * @brief Find an event
+   * @details With several entries of the same event, the first one in the
+   *          list of files.
+   *
+   * @return The entry over all the files back to back, -1 if not found
+   */
+  long long find(unsigned int run, unsigned int subrun, unsigned int event) const;
+
+  /// Find an event when the subrun is not known, the lowest subrun with that event
+  long long find(unsigned int run, unsigned int event) const;
+
+  /// Where an entry over all the files back to back is
+  location_t locate(long long entry) const;
+
+private:
+
+  /// Recompute the lookups from _locations
+  void sort();
+
+  struct file_t {
+    std::string path;
+    long long size;
+    long long mtime;
+    long long n_entries;
+  };
+
+  /// Size and modification time of a file now, false if it can not be read
+  static bool stat(const std::string& path, file_t& file);
+
+  std::vector<file_t> _files;
+
+  /// First entry of each file, then the number of entries
+  std::vector<long long> _file_first;
+
+  /// Sorted by (run, subrun, event, file, entry)
+  std::vector<location_t> _locations;
+
+  /// Indices in _locations sorted by (run, event, subrun)
+  std::vector<size_t> _by_run_event;
+
+  /// Index in _locations of each entry
+  std::vector<size_t> _by_entry;
+
+};
+}
+#endif
+
+/** @} */ // end of doxygen group
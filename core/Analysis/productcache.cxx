@@ -0,0 +1,159 @@
+#ifndef GALLERY_FMWK_PRODUCTCACHE_CXX
+#define GALLERY_FMWK_PRODUCTCACHE_CXX
+
+#include "productcache.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sys/stat.h>
+
+#include "Base/messenger.h"
+#include "TBranch.h"
+#include "TFile.h"
+#include "TObjArray.h"
+#include "TString.h"
+#include "TTree.h"
+
+namespace galleryfmwk {
+
+namespace {
+
+/// First line of a sidecar, change the number when the format changes
+const char* kSidecarVersion = "galleryfmwk::productcache 1";
+
+/// GUID of an open file
+std::string file_guid(TFile& file) {
+  return file.GetUUID().AsString();
+}
+
+/// Branches of the Events tree of an open file
+bool read_products(TFile& file, std::vector<std::string>& names, std::vector<std::string>& types) {
+  TTree* events = dynamic_cast<TTree*>(file.Get("Events"));
+  if (!events) return false;
+
+  TObjArray* branches = events->GetListOfBranches();
+  names.reserve(branches->GetEntriesFast());
+  types.reserve(branches->GetEntriesFast());
+  for (int i = 0; i < branches->GetEntriesFast(); ++i) {
+    TBranch* branch = static_cast<TBranch*>(branches->At(i));
+    names.push_back(branch->GetName());
+    types.push_back(branch->GetClassName());
+  }
+  return true;
+}
+
+}
+
+void productcache::clear() {
+  _guid.clear();
+  _names.clear();
+  _types.clear();
+}
+
+std::string productcache::sidecar(const std::string& cache_dir, const std::string& guid) {
+  return cache_dir + "/" + guid + ".products";
+}
+
+bool productcache::open(const std::string& file, const std::string& cache_dir) {
+
+  clear();
+
+  // Only the header is read to get the GUID
+  std::unique_ptr<TFile> input(TFile::Open(file.c_str()));
+  if (!input || input->IsZombie()) {
+    Message::send(__PRETTY_FUNCTION__, Form("Can not open %s", file.c_str()));
+    return false;
+  }
+  std::string guid = file_guid(*input);
+
+  if (!cache_dir.empty() && load(sidecar(cache_dir, guid), guid)) return true;
+
+  _guid = guid;
+  if (!read_products(*input, _names, _types)) {
+    Message::send(__PRETTY_FUNCTION__, Form("No Events tree in %s", file.c_str()));
+    clear();
+    return false;
+  }
+
+  if (!cache_dir.empty()) {
+    if (::mkdir(cache_dir.c_str(), 0755) != 0 && errno != EEXIST)
+      Message::send(__FUNCTION__, Form("Could not create %s", cache_dir.c_str()));
+    else if (!save(sidecar(cache_dir, guid)))
+      Message::send(__FUNCTION__, Form("Could not save the products of %s", file.c_str()));
+  }
+
+  return true;
+}
+
+bool productcache::read(const std::string& file) {
+
+  clear();
+
+  std::unique_ptr<TFile> input(TFile::Open(file.c_str()));
+  if (!input || input->IsZombie() || !read_products(*input, _names, _types)) {
+    Message::send(__PRETTY_FUNCTION__, Form("Can not read the products of %s", file.c_str()));
+    clear();
+    return false;
+  }
+  _guid = file_guid(*input);
+
+  return true;
+}
+
+bool productcache::load(const std::string& sidecar, const std::string& guid) {
+
+  clear();
+
+  std::ifstream in(sidecar.c_str());
+  if (!in) return false;
+
+  std::string version;
+  std::getline(in, version);
+  if (version != kSidecarVersion) return false;
+
+  std::getline(in, _guid);
+  size_t n_products;
+  in >> n_products;
+  if (!in || _guid != guid) {
+    clear();
+    return false;
+  }
+
+  // Branch names have no spaces, the class is the rest of the line
+  _names.resize(n_products);
+  _types.resize(n_products);
+  for (size_t i = 0; i < n_products && in; ++i) {
+    in >> _names[i];
+    in.get();
+    std::getline(in, _types[i]);
+  }
+  if (!in) {
+    clear();
+    return false;
+  }
+
+  return true;
+}
+
+bool productcache::save(const std::string& sidecar) const {
+
+  // Write aside and rename, so a reader never sees half a file
+  std::string tmp = sidecar + ".tmp";
+  {
+    std::ofstream out(tmp.c_str());
+    if (!out) return false;
+
+    out << kSidecarVersion << "\n" << _guid << "\n" << _names.size() << "\n";
+    for (size_t i = 0; i < _names.size(); ++i)
+      out << _names[i] << " " << _types[i] << "\n";
+
+    if (!out) return false;
+  }
+
+  return std::rename(tmp.c_str(), sidecar.c_str()) == 0;
+}
+
+}
+#endif
@@ -0,0 +1,90 @@
+/**
+ * \file productcache.h
+ *
+ * \ingroup Analysis
+ *
+ * \brief Data products of an art file, cached by the GUID of the file
+ *
+ * @author cadams
+ */
+
+/** \addtogroup Analysis
+
+    @{*/
+#ifndef GALLERY_FMWK_PRODUCTCACHE_H
+#define GALLERY_FMWK_PRODUCTCACHE_H
+
+#include <string>
+#include <vector>
+
+namespace galleryfmwk {
+/**
+   \class productcache
+   Branch name and class of every product in the Events tree of an art file,
+   from which the event display builds its product, producer and stage menus.
+
+   Reading the list means reading the whole description of the Events tree,
+   which is slow for files with hundreds of branches.  The list is saved to a
+   small sidecar in a cache directory, named after the GUID of the file (the
+   UUID ROOT writes in the file header), so opening the file again only
+   reads its header.
+*/
+class productcache {
+
+public:
+
+  /// Default constructor
+  productcache() {}
+
+  /// Default destructor
+  virtual ~productcache() {}
+
+  /**
+   * @brief Products of a file, from its sidecar in cache_dir if there is one
+   * @details Otherwise the products are read from the file and saved to
+   *          cache_dir, which is created if needed.  An empty cache_dir only
+   *          reads.
+   *
+   * @param file The art file
+   * @param cache_dir Directory of the sidecars
+   */
+  bool open(const std::string& file, const std::string& cache_dir = "");
+
+  /// Read the products from the file
+  bool read(const std::string& file);
+
+  /// Load from a sidecar file, false if it is not the one of this GUID
+  bool load(const std::string& sidecar, const std::string& guid);
+
+  /// Save to a sidecar file
+  bool save(const std::string& sidecar) const;
+
+  /// Forget the file
+  void clear();
+
+  /// GUID of the file
+  const std::string& guid() const {return _guid;}
+
+  /// Number of products
+  size_t size() const {return _names.size();}
+
+  /// Branch name of a product, as in "recob::Hits_gaushit__Reco."
+  const std::string& name(size_t i) const {return _names.at(i);}
+
+  /// Class of the branch of a product, as in "art::Wrapper<vector<recob::Hit> >"
+  const std::string& type(size_t i) const {return _types.at(i);}
+
+  /// Path of the sidecar of a GUID in cache_dir
+  static std::string sidecar(const std::string& cache_dir, const std::string& guid);
+
+private:
+
+  std::string _guid;
+  std::vector<std::string> _names;
+  std::vector<std::string> _types;
+
+};
+}
+#endif
+
+/** @} */ // end of doxygen group
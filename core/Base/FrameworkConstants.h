@@ -33,6 +33,18 @@ const double kINVALID_DOUBLE = std::numeric_limits<double>::max();
 const float  kINVALID_FLOAT  = std::numeric_limits<float>::max();
 }
 
+/// Message levels, see Message
+namespace msg {
+  enum Level {
+    kDEBUG = 0,    ///< Compiled out unless GALLERY_FMWK_MSG_LEVEL is 0
+    kINFO,         ///< Progress of a job
+    kNORMAL,       ///< What a user should see
+    kWARNING,      ///< Something went wrong, the job goes on
+    kERROR,        ///< Something went wrong, written out at once
+    kMSG_TYPE_MAX
+  };
+}
+
 /// Defines constants for Message utility
 namespace message {
 
@@ -12,7 +12,8 @@
 #pragma link C++ namespace galleryfmwk+;
 #pragma link C++ namespace galleryfmwk::simb+;
 #pragma link C++ namespace galleryfmwk::anab+;
-//#pragma link C++ namespace galleryfmwk::msg+;
+#pragma link C++ namespace galleryfmwk::msg+;
+#pragma link C++ enum galleryfmwk::msg::Level+;
 #pragma link C++ namespace galleryfmwk::larch+;
 #pragma link C++ namespace galleryfmwk::data+;
 // #pragma link C++ class galleryfmwk::data+;
@@ -3,32 +3,242 @@
 
 #include "messenger.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace galleryfmwk {
+
+namespace {
+
+/// Messages of one thread.  Only that thread pushes, and only the thread
+/// holding the drain lock of the backend pops, so head and tail are enough.
+class ring {
+
+public:
+
+  /// Longest where + message kept, longer ones are cut
+  static const size_t kTEXT = 500;
+
+  /// Number of messages a thread can have waiting
+  static const size_t kSLOTS = 256;
+
+  ring() : _head(0), _tail(0), _orphan(false) {}
+
+  /// False if the ring is full
+  bool push(msg::Level level, const std::string& where, const std::string& text)
+  {
+    size_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) == kSLOTS) return false;
+
+    record_t& record = _records[head % kSLOTS];
+    record.level = level;
+    record.where = std::min(where.size(), kTEXT);
+    record.size = std::min(where.size() + text.size(), kTEXT);
+    std::memcpy(record.text, where.data(), record.where);
+    std::memcpy(record.text + record.where, text.data(), record.size - record.where);
+
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Append the oldest message to out as a line, false if there is none
+  bool pop(std::string& out)
+  {
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) return false;
+
+    const record_t& record = _records[tail % kSLOTS];
+    out += message::ColorPrefix[record.level];
+    out += message::StringPrefix[record.level];
+    out += "\033[0m";
+    if (record.where) {
+      out += "\033[95m<";
+      out.append(record.text, record.where);
+      out += "> \033[0m";
+    }
+    out.append(record.text + record.where, record.size - record.where);
+    out += "\n";
+
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const
+  {
+    return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire);
+  }
+
+  /// Set when the thread is gone, the ring is dropped once empty
+  void orphan() {_orphan.store(true, std::memory_order_release);}
+  bool is_orphan() const {return _orphan.load(std::memory_order_acquire);}
+
+private:
+
+  struct record_t {
+    msg::Level level;
+    size_t where;    ///< Length of where at the start of text
+    size_t size;     ///< Length of where and the message
+    char text[kTEXT];
+  };
+
+  std::atomic<size_t> _head;
+  std::atomic<size_t> _tail;
+  std::atomic<bool> _orphan;
+  record_t _records[kSLOTS];
+};
+
+/// The rings of all the threads and the thread writing them out
+class backend {
+
+public:
+
+  /// Never deleted, threads may still send while statics are destroyed
+  static backend& get()
+  {
+    static backend* me = new backend();
+    return *me;
+  }
+
+  /// The ring of the calling thread, made on its first message
+  ring& local()
+  {
+    struct owner_t {
+      std::shared_ptr<ring> r;
+      ~owner_t() {if (r) r->orphan();}
+    };
+    static thread_local owner_t owner;
+
+    if (!owner.r) {
+      owner.r = std::make_shared<ring>();
+      std::lock_guard<std::mutex> lock(_rings_mutex);
+      _rings.push_back(owner.r);
+    }
+    return *owner.r;
+  }
+
+  /// Write out every waiting message
+  void drain()
+  {
+    std::lock_guard<std::mutex> drain_lock(_drain_mutex);
+
+    std::vector<std::shared_ptr<ring> > rings;
+    {
+      std::lock_guard<std::mutex> lock(_rings_mutex);
+      rings = _rings;
+    }
+
+    _buffer.clear();
+    for (auto const& r : rings)
+      while (r->pop(_buffer));
+    if (!_buffer.empty()) {
+      std::cout << _buffer;
+      std::cout.flush();
+    }
+
+    // A thread that is gone sends nothing more
+    std::lock_guard<std::mutex> lock(_rings_mutex);
+    _rings.erase(std::remove_if(_rings.begin(), _rings.end(),
+                                [](const std::shared_ptr<ring>& r) {return r->is_orphan() && r->empty();}),
+                 _rings.end());
+  }
+
+  /// Start the writer, once
+  void start()
+  {
+    std::call_once(_started, [this]() {
+      _writer = std::thread(&backend::write, this);
+      std::atexit([]() {backend::get().stop();});
+    });
+  }
+
+  void stop()
+  {
+    _stop.store(true);
+    if (_writer.joinable()) _writer.join();
+    drain();
+  }
+
+  bool stopped() const {return _stop.load(std::memory_order_relaxed);}
+
+  std::atomic<int> level;
+
+private:
+
+  backend() : level(msg::kINFO), _stop(false) {}
+
+  void write()
+  {
+    while (!_stop.load()) {
+      drain();
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+  }
+
+  std::mutex _rings_mutex;
+  std::vector<std::shared_ptr<ring> > _rings;
+
+  std::mutex _drain_mutex;
+  std::string _buffer;
+
+  std::once_flag _started;
+  std::thread _writer;
+  std::atomic<bool> _stop;
+};
+
+}
+
   Message* Message::me = 0;
   
   void Message::send(std::string msg)
   {
-    std::cout 
-      << message::ColorPrefix[3].c_str()
-      << message::StringPrefix[3].c_str()
-      << "\033[0m"
-      << msg.c_str()
-      << std::endl;
+    send(msg::kWARNING, std::string(), msg);
   }
   
   void Message::send(std::string where, std::string msg)
   {
-    std::cout 
-      << message::ColorPrefix[3].c_str()
-      << message::StringPrefix[3].c_str()
-      << "\033[0m"
-      << "\033[95m"
-      << "<"
-      << where.c_str()
-      << "> "
-      << "\033[0m"
-      << msg.c_str()
-      << std::endl;
+    send(msg::kWARNING, where, msg);
+  }
+
+  void Message::send(msg::Level level, const std::string& msg)
+  {
+    send(level, std::string(), msg);
+  }
+
+  void Message::send(msg::Level level, const std::string& where, const std::string& msg)
+  {
+    if (level >= msg::kMSG_TYPE_MAX) level = msg::kERROR;
+    if (!is_enabled(level)) return;
+
+    backend& b = backend::get();
+    b.start();
+
+    // A full ring is written out by this thread, nothing is lost
+    ring& r = b.local();
+    while (!r.push(level, where, msg)) b.drain();
+
+    if (level >= msg::kERROR || b.stopped()) b.drain();
+  }
+
+  void Message::set_level(msg::Level level)
+  {
+    backend::get().level.store(level, std::memory_order_relaxed);
+  }
+
+  bool Message::is_enabled(msg::Level level)
+  {
+    return level >= backend::get().level.load(std::memory_order_relaxed);
+  }
+
+  void Message::flush()
+  {
+    backend::get().drain();
   }
 
 }
@@ -24,6 +24,18 @@ namespace galleryfmwk {
   /**
      \class Message
      \brief Utility class used to show formatted message on the screen.
+
+     Messages are not written by the thread that sends them.  Each thread
+     puts its messages in its own ring buffer, without a lock, and a
+     background thread writes them to std::cout, one whole line at a time.
+     The messages of one thread keep their order.  An ERROR message, or any
+     message sent while the ring of its thread is full, is written before
+     send returns, and everything is written at exit.
+
+     Messages below the level set with set_level are skipped, and the
+     GALLERY_FMWK_MSG macro skips them before building the text.  Messages
+     below GALLERY_FMWK_MSG_LEVEL (kINFO unless defined at compile time)
+     are compiled out by it, so debug messages in a loop cost nothing.
   */
   class Message{
     
@@ -50,14 +62,46 @@ namespace galleryfmwk {
       return me;
     };
     
-    /// Static method to send message out.
+    /// Static method to send message out, as a WARNING.
     static void send(std::string msg);
     
     /// Extra argument "where" is used to indicate function/class name.
     static void send(std::string where, std::string msg);
+
+    /// Send a message of a level
+    static void send(msg::Level level, const std::string& msg);
+
+    /// Send a message of a level, "where" is the function/class name.
+    static void send(msg::Level level, const std::string& where, const std::string& msg);
+
+    /// Lowest level written, kINFO by default
+    static void set_level(msg::Level level);
+
+    /// True if messages of this level are written
+    static bool is_enabled(msg::Level level);
+
+    /// Write every message sent so far before returning
+    static void flush();
     
   };
 }
+
+#ifndef GALLERY_FMWK_MSG_LEVEL
+/// Messages below this galleryfmwk::msg::Level are compiled out by GALLERY_FMWK_MSG
+#define GALLERY_FMWK_MSG_LEVEL 1
+#endif
+
+/// Send a message if its level is enabled, the text is not built otherwise
+#define GALLERY_FMWK_MSG(level, where, text)                            \
+  do {                                                                  \
+    if ((level) >= GALLERY_FMWK_MSG_LEVEL &&                            \
+        galleryfmwk::Message::is_enabled(level))                        \
+      galleryfmwk::Message::send((level), (where), (text));             \
+  } while (0)
+
+/// A debug message, compiled out unless GALLERY_FMWK_MSG_LEVEL is 0
+#define GALLERY_FMWK_DEBUG(where, text) GALLERY_FMWK_MSG(galleryfmwk::msg::kDEBUG, where, text)
+
 #endif
   
 /** @} */ // end of doxygen group Message
@@ -0,0 +1,100 @@
+#ifndef GALLERY_FMWK_THREADPOOL_CXX
+#define GALLERY_FMWK_THREADPOOL_CXX
+
+#include "threadpool.h"
+
+namespace galleryfmwk {
+
+threadpool::threadpool(unsigned int n_threads) :
+  _job(0),
+  _n_tasks(0),
+  _next_task(0),
+  _job_id(0),
+  _n_busy(0),
+  _stop(false)
+{
+  if (n_threads == 0) {
+    n_threads = std::thread::hardware_concurrency();
+  }
+  // The calling thread is one of the threads:
+  for (unsigned int i = 1; i < n_threads; i ++) {
+    _workers.push_back(std::thread(&threadpool::work, this, i));
+  }
+}
+
+threadpool::~threadpool() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _start_condition.notify_all();
+  for (auto & worker : _workers) {
+    worker.join();
+  }
+}
+
+void threadpool::run(int n_tasks, const std::function<void(int, int)> & func) {
+
+  if (n_tasks <= 0) {
+    return;
+  }
+
+  if (_workers.empty() || n_tasks == 1) {
+    for (int task = 0; task < n_tasks; task ++) {
+      func(task, 0);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _job = &func;
+    _n_tasks = n_tasks;
+    _next_task = 0;
+    _n_busy = _workers.size();
+    _job_id ++;
+  }
+  _start_condition.notify_all();
+
+  drain(0);
+
+  // Wait for the workers to finish their last task:
+  std::unique_lock<std::mutex> lock(_mutex);
+  _done_condition.wait(lock, [this] {return _n_busy == 0;});
+  _job = 0;
+}
+
+void threadpool::drain(int thread) {
+  int task;
+  while ((task = _next_task++) < _n_tasks) {
+    (*_job)(task, thread);
+  }
+}
+
+void threadpool::work(int thread) {
+
+  unsigned int last_job = 0;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _start_condition.wait(lock, [this, last_job] {return _stop || _job_id != last_job;});
+      if (_stop) {
+        return;
+      }
+      last_job = _job_id;
+    }
+
+    drain(thread);
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _n_busy --;
+    }
+    _done_condition.notify_one();
+  }
+}
+
+} // galleryfmwk
+
+#endif
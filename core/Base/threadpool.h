@@ -0,0 +1,89 @@
+/**
+ * \file threadpool.h
+ *
+ * \ingroup Base
+ *
+ * \brief Class def header for a class threadpool
+ *
+ * A small pool of worker threads that stay alive between events.  Work is
+ * handed out as a number of independent tasks (for example, batches of
+ * wires, or the analysis modules of one scheduler stage); each worker takes
+ * the next task until none are left.
+ *
+ * @author cadams
+ */
+
+/** \addtogroup Base
+
+    @{*/
+#ifndef GALLERY_FMWK_THREADPOOL_H
+#define GALLERY_FMWK_THREADPOOL_H
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace galleryfmwk {
+
+/**
+   \class threadpool
+   Fixed size pool of worker threads, shared by the analysis scheduler and
+   the noise filter stages.
+ */
+class threadpool {
+
+public:
+
+  /**
+   * @brief Start the pool
+   * @param n_threads Number of threads working on each call to run,
+   *                  including the calling thread.  0 means one per core.
+   */
+  threadpool(unsigned int n_threads = 0);
+
+  /// Default destructor, stops and joins the workers
+  ~threadpool();
+
+  /// Number of threads working on each call to run, including the caller
+  unsigned int n_threads() const {return _workers.size() + 1;}
+
+  /**
+   * @brief Run func(task, thread) for every task in [0, n_tasks)
+   * @details Blocks until all tasks are done.  The calling thread takes part
+   *          as thread 0, the workers are threads 1 to n_threads() - 1, so
+   *          the thread index can be used to pick per-thread scratch space.
+   *          Not reentrant: func must not call run on the same pool.
+   */
+  void run(int n_tasks, const std::function<void(int, int)> & func);
+
+private:
+
+  /// Loop of each worker thread
+  void work(int thread);
+
+  /// Take tasks from the current job until there are none left
+  void drain(int thread);
+
+  std::vector<std::thread> _workers;
+
+  std::mutex _mutex;
+  std::condition_variable _start_condition;
+  std::condition_variable _done_condition;
+
+  // The current job, protected by _mutex except for the task counter
+  const std::function<void(int, int)> * _job;
+  int _n_tasks;
+  std::atomic<int> _next_task;
+  unsigned int _job_id;
+  unsigned int _n_busy;
+  bool _stop;
+
+};
+
+} // galleryfmwk
+
+#endif
+/** @} */ // end of doxygen group